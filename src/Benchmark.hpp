@@ -0,0 +1,274 @@
+#pragma once
+// Strong and weak scaling benchmark of the simulation engine
+#include "TruckSim.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// \brief Settings of a scaling benchmark
+struct BenchmarkOptions {
+  enum class Scaling { STRONG, WEAK };
+  enum class Format { CSV, JSON };
+
+  // Strong: the fleet of the base configuration on every thread count.
+  // Weak: the base fleet per thread, with stations scaled alike.
+  Scaling scaling = Scaling::STRONG;
+  Format format = Format::CSV;
+  std::vector<int> threadCounts; // empty means 1, 2, 4, hardware_concurrency
+  uint32_t trials = 5;
+  uint32_t warmupTrials = 1;
+  // Record thread-pool telemetry and print it after the timings
+  bool telemetry = false;
+};
+
+/// \brief Timing summary of one thread count
+struct BenchmarkRow {
+  int threads = 0;
+  uint32_t trucks = 0;
+  uint32_t stations = 0;
+  uint64_t ticks = 0;
+  double medianMs = 0.0;
+  double q1Ms = 0.0;
+  double q3Ms = 0.0;
+  double ticksPerSec = 0.0;
+  double efficiency = 0.0; // parallel efficiency against the first row
+  PoolTelemetry telemetry;  // of the last timed trial, when recorded
+};
+
+/// \brief Times TruckSim::run() alone (construction and reporting excluded)
+/// over repeated trials after warm-up trials, for each thread count
+class Benchmark {
+  SimConfig m_base;
+  BenchmarkOptions m_options;
+  std::vector<BenchmarkRow> m_rows;
+
+  SimConfig configFor(int threads) const {
+    SimConfig config = m_base;
+    config.numThreads = threads;
+    config.quiet = true;
+    config.poolTelemetry = m_options.telemetry;
+    // Every trial simulates exactly the same workload
+    config.seed = m_base.seed ? *m_base.seed : 1;
+    if (m_options.scaling == BenchmarkOptions::Scaling::WEAK) {
+      config.numTrucks = m_base.numTrucks * threads;
+      config.numStations = m_base.numStations * threads;
+    }
+    return config;
+  }
+
+  // Runs one timed simulation, in milliseconds
+  static double timeRun(const SimConfig &config, uint64_t &ticks,
+                        PoolTelemetry &telemetry) {
+    TruckSim sim(config);
+    ticks = sim.getDurationTicks();
+    auto startTime = std::chrono::steady_clock::now();
+    sim.run();
+    auto endTime = std::chrono::steady_clock::now();
+    telemetry = sim.getPoolTelemetry();
+    return std::chrono::duration<double, std::milli>(endTime - startTime)
+        .count();
+  }
+
+  static double toMs(uint64_t ns) { return ns / 1e6; }
+
+  // Prints the pool counters of every row: one CSV row per worker, or one
+  // JSON line per thread count
+  void printTelemetry(std::ostream &out) const {
+    bool csv = m_options.format == BenchmarkOptions::Format::CSV;
+    if (csv) {
+      out << "\nthreads,worker,tasks,busy_ms,idle_ms,lock_wait_ms,"
+             "start_latency_p50_ns,start_latency_p99_ns,start_latency_max_ns,"
+             "max_queue_depth,enqueue_lock_wait_ms\n";
+    }
+    for (const BenchmarkRow &row : m_rows) {
+      const PoolTelemetry &pool = row.telemetry;
+      if (pool.workers.empty()) {
+        continue;
+      }
+      if (!csv) {
+        out << "{\"telemetry\":{\"threads\":" << row.threads
+            << ",\"tasks_enqueued\":" << pool.tasksEnqueued
+            << ",\"max_queue_depth\":" << pool.maxQueueDepth
+            << ",\"enqueue_lock_wait_ms\":" << toMs(pool.enqueueLockWaitNs)
+            << ",\"utilization\":" << pool.utilization() << ",\"workers\":[";
+      }
+      for (size_t i = 0; i < pool.workers.size(); ++i) {
+        const WorkerTelemetry &worker = pool.workers[i];
+        const Histogram &latency = worker.startLatencyNs;
+        if (csv) {
+          out << row.threads << "," << i << "," << worker.tasksRun << ","
+              << toMs(worker.busyNs) << "," << toMs(worker.idleNs) << ","
+              << toMs(worker.lockWaitNs) << "," << latency.getPercentile(50.0)
+              << "," << latency.getPercentile(99.0) << "," << latency.getMax()
+              << "," << pool.maxQueueDepth << ","
+              << toMs(pool.enqueueLockWaitNs) << "\n";
+        } else {
+          out << (i > 0 ? "," : "") << "{\"tasks\":" << worker.tasksRun
+              << ",\"busy_ms\":" << toMs(worker.busyNs)
+              << ",\"idle_ms\":" << toMs(worker.idleNs)
+              << ",\"lock_wait_ms\":" << toMs(worker.lockWaitNs)
+              << ",\"start_latency_p50_ns\":" << latency.getPercentile(50.0)
+              << ",\"start_latency_p99_ns\":" << latency.getPercentile(99.0)
+              << ",\"start_latency_max_ns\":" << latency.getMax() << "}";
+        }
+      }
+      if (!csv) {
+        out << "]}}\n";
+      }
+    }
+  }
+
+public:
+  Benchmark(const SimConfig &base, const BenchmarkOptions &options)
+      : m_base(base), m_options(options) {
+    if (m_options.threadCounts.empty()) {
+      int hardware = std::max(1u, std::thread::hardware_concurrency());
+      m_options.threadCounts = {1, 2, 4};
+      if (hardware > 4) {
+        m_options.threadCounts.push_back(hardware);
+      }
+    }
+    m_options.trials = std::max<uint32_t>(m_options.trials, 1);
+  }
+
+  /// \brief Quantile of sorted samples with linear interpolation
+  static double quantile(const std::vector<double> &sorted, double q) {
+    if (sorted.empty()) {
+      return 0.0;
+    }
+    double position = q * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(position);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    double fraction = position - lower;
+    return sorted[lower] + fraction * (sorted[upper] - sorted[lower]);
+  }
+
+  /// \brief Fills the timings and rates of a row (its threads, trucks and
+  /// ticks already set) from the trial durations, in milliseconds
+  static void summarize(BenchmarkRow &row, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    row.medianMs = quantile(samples, 0.5);
+    row.q1Ms = quantile(samples, 0.25);
+    row.q3Ms = quantile(samples, 0.75);
+    double seconds = row.medianMs / 1000.0;
+    row.ticksPerSec = seconds > 0.0 ? row.ticks / seconds : 0.0;
+  }
+
+  /// \brief Parallel efficiency of a row against the base row. Strong:
+  /// T_b p_b / (T_p p). Weak: T_b / T_p, the work grows with p.
+  static double efficiency(BenchmarkOptions::Scaling scaling,
+                           const BenchmarkRow &base, const BenchmarkRow &row) {
+    if (scaling == BenchmarkOptions::Scaling::STRONG) {
+      return (base.medianMs * base.threads) / (row.medianMs * row.threads);
+    }
+    return base.medianMs / row.medianMs;
+  }
+
+  /// \brief Parses the command-line name of a scaling mode
+  static std::optional<BenchmarkOptions::Scaling> parseScaling(const std::string &name) {
+    if (name == "strong") {
+      return BenchmarkOptions::Scaling::STRONG;
+    }
+    if (name == "weak") {
+      return BenchmarkOptions::Scaling::WEAK;
+    }
+    return std::nullopt;
+  }
+
+  /// \brief Parses the command-line name of an output format
+  static std::optional<BenchmarkOptions::Format> parseFormat(const std::string &name) {
+    if (name == "csv") {
+      return BenchmarkOptions::Format::CSV;
+    }
+    if (name == "json") {
+      return BenchmarkOptions::Format::JSON;
+    }
+    return std::nullopt;
+  }
+
+  /// \brief Parses a comma-separated list of thread counts
+  static std::vector<int> parseThreadCounts(const std::string &list) {
+    std::vector<int> counts;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+      if (!item.empty()) {
+        counts.push_back(std::max(1, std::stoi(item)));
+      }
+    }
+    return counts;
+  }
+
+  const std::vector<BenchmarkRow> &getRows() const { return m_rows; }
+
+  /// \brief Runs every thread count
+  void run() {
+    m_rows.clear();
+    for (int threads : m_options.threadCounts) {
+      SimConfig config = configFor(threads);
+      uint64_t ticks = 0;
+      PoolTelemetry telemetry;
+      for (uint32_t w = 0; w < m_options.warmupTrials; ++w) {
+        timeRun(config, ticks, telemetry);
+      }
+
+      std::vector<double> samples;
+      samples.reserve(m_options.trials);
+      for (uint32_t t = 0; t < m_options.trials; ++t) {
+        samples.push_back(timeRun(config, ticks, telemetry));
+      }
+
+      BenchmarkRow row;
+      row.threads = threads;
+      row.trucks = config.numTrucks;
+      row.stations = config.numStations;
+      row.ticks = ticks;
+      row.telemetry = std::move(telemetry);
+      summarize(row, std::move(samples));
+      row.efficiency = efficiency(m_options.scaling,
+                                  m_rows.empty() ? row : m_rows.front(), row);
+      m_rows.push_back(row);
+    }
+  }
+
+  /// \brief Prints the rows as CSV or JSON lines, followed by the pool
+  /// telemetry when it was recorded
+  void print(std::ostream &out) const {
+    const char *scaling =
+        m_options.scaling == BenchmarkOptions::Scaling::STRONG ? "strong"
+                                                               : "weak";
+    out << std::fixed << std::setprecision(3);
+    if (m_options.format == BenchmarkOptions::Format::CSV) {
+      out << "scaling,threads,trucks,stations,ticks,trials,median_ms,q1_ms,"
+             "q3_ms,iqr_ms,ticks_per_sec,efficiency\n";
+    }
+    for (const BenchmarkRow &row : m_rows) {
+      if (m_options.format == BenchmarkOptions::Format::CSV) {
+        out << scaling << "," << row.threads << "," << row.trucks << ","
+            << row.stations << "," << row.ticks << "," << m_options.trials
+            << "," << row.medianMs << "," << row.q1Ms << "," << row.q3Ms
+            << "," << row.q3Ms - row.q1Ms << "," << row.ticksPerSec << ","
+            << row.efficiency << "\n";
+      } else {
+        out << "{\"scaling\":\"" << scaling << "\",\"threads\":" << row.threads
+            << ",\"trucks\":" << row.trucks << ",\"stations\":" << row.stations
+            << ",\"ticks\":" << row.ticks << ",\"trials\":" << m_options.trials
+            << ",\"median_ms\":" << row.medianMs << ",\"q1_ms\":" << row.q1Ms
+            << ",\"q3_ms\":" << row.q3Ms
+            << ",\"iqr_ms\":" << row.q3Ms - row.q1Ms
+            << ",\"ticks_per_sec\":" << row.ticksPerSec
+            << ",\"efficiency\":" << row.efficiency << "}\n";
+      }
+    }
+    if (m_options.telemetry) {
+      printTelemetry(out);
+    }
+    out.flush();
+  }
+};
@@ -0,0 +1,56 @@
+#pragma once
+// Conversions between the C API structs (minesim.h) and the simulation types
+#include "minesim.h"
+#include "TruckSim.hpp"
+
+/// \brief Checks a C configuration
+/// \return MINESIM_OK or MINESIM_ERR_INVALID_ARGUMENT
+inline int validateConfig(const minesim_config &config) {
+  if (!(config.horizon_secs > 0.0) || config.warmup_secs < 0.0 ||
+      config.warmup_secs >= config.horizon_secs ||
+      config.dispatch < MINESIM_DISPATCH_FIFO ||
+      config.dispatch > MINESIM_DISPATCH_ROUND_ROBIN) {
+    return MINESIM_ERR_INVALID_ARGUMENT;
+  }
+  return MINESIM_OK;
+}
+
+/// \brief Builds the single-threaded, quiet run of a valid C configuration
+inline SimConfig toSimConfig(const minesim_config &config) {
+  SimConfig simConfig;
+  simConfig.numTrucks = config.num_trucks;
+  simConfig.numStations = config.num_stations;
+  simConfig.numThreads = 1; // parallelism comes from the batch
+  simConfig.seed = config.seed;
+  simConfig.antithetic = config.antithetic != 0;
+  simConfig.quiet = true;
+  simConfig.horizonSecs = config.horizon_secs;
+  simConfig.warmupSecs = config.warmup_secs;
+  simConfig.autoWarmup = config.auto_warmup != 0;
+  simConfig.dispatch = static_cast<DispatchRule>(config.dispatch);
+  return simConfig;
+}
+
+inline minesim_percentiles toPercentiles(const PercentileSummary &summary) {
+  return {summary.count, summary.p50, summary.p90, summary.p99, summary.max};
+}
+
+/// \brief Fills the totals and metrics of a result (not its status)
+inline void fillResult(const SimResults &sim, minesim_result &result) {
+  result.num_trucks = sim.numTrucks;
+  result.num_stations = sim.numStations;
+  result.duration_secs = sim.durationSecs;
+  result.warmup_secs = sim.warmupSecs;
+  result.total_mining_time = sim.totalMiningTime;
+  result.total_unload_time = sim.totalUnloadTime;
+  result.total_travel_time = sim.totalTravelTime;
+  result.total_idle_time = sim.totalIdleTime;
+  result.total_station_occupied_time = sim.totalStationOccupiedTime;
+  result.trips_completed = sim.tripsCompleted;
+  result.truck_idle_rate = sim.truckIdleRate();
+  result.station_utilization = sim.stationUtilization();
+  result.throughput_per_station = sim.throughputPerStation();
+  result.queue_wait = toPercentiles(sim.queueWait);
+  result.cycle_time = toPercentiles(sim.cycleTime);
+  result.service_time = toPercentiles(sim.serviceTime);
+}
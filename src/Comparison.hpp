@@ -0,0 +1,251 @@
+#pragma once
+// Paired comparison of two simulation configurations
+#include "LaneSim.hpp"
+#include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "TruckSim.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// \brief Two-sided 95% quantile of Student's t distribution
+inline double studentT975(uint64_t degreesOfFreedom) {
+  static constexpr std::array<double, 30> TABLE = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (degreesOfFreedom == 0) {
+    return INFINITY;
+  }
+  if (degreesOfFreedom <= TABLE.size()) {
+    return TABLE[degreesOfFreedom - 1];
+  }
+  // Cornish-Fisher expansion around the normal quantile
+  double z = 1.959964;
+  double v = static_cast<double>(degreesOfFreedom);
+  return z + (z * z * z + z) / (4.0 * v) +
+         (5.0 * std::pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * v * v);
+}
+
+/// \brief Running mean and variance of paired differences (Welford)
+class PairedDifference {
+  uint64_t m_count = 0;
+  double m_meanA = 0.0;
+  double m_meanB = 0.0;
+  double m_meanDiff = 0.0;
+  double m_m2 = 0.0;
+
+public:
+  /// \brief Adds one paired observation
+  void add(double a, double b) {
+    m_count++;
+    double n = static_cast<double>(m_count);
+    m_meanA += (a - m_meanA) / n;
+    m_meanB += (b - m_meanB) / n;
+    double diff = b - a;
+    double delta = diff - m_meanDiff;
+    m_meanDiff += delta / n;
+    m_m2 += delta * (diff - m_meanDiff);
+  }
+
+  uint64_t getCount() const { return m_count; }
+  double getMeanA() const { return m_meanA; }
+  double getMeanB() const { return m_meanB; }
+
+  /// \brief Retrieves the mean of (b - a)
+  double getMeanDiff() const { return m_meanDiff; }
+
+  /// \brief Retrieves the sample standard deviation of (b - a)
+  double getStdDev() const {
+    return m_count > 1 ? std::sqrt(m_m2 / (m_count - 1)) : 0.0;
+  }
+
+  /// \brief Retrieves the half width of the 95% confidence interval
+  double getHalfWidth() const {
+    if (m_count < 2) {
+      return INFINITY;
+    }
+    return studentT975(m_count - 1) * getStdDev() /
+           std::sqrt(static_cast<double>(m_count));
+  }
+};
+
+/// \brief Replication settings of a paired comparison
+struct ComparisonOptions {
+  uint32_t replications = 10;
+  uint64_t baseSeed = 1;
+  // Use the same seed for both configurations within a replication
+  bool commonRandomNumbers = true;
+  // Each replication averages a run and its antithetic twin
+  bool antithetic = false;
+  // Replications batched per LaneSim run (8), 0 runs them one by one
+  uint32_t lanes = 8;
+  // Threads running the replications of both configurations
+  uint32_t parallelism = 0; // 0 means use hardware_concurrency
+  // Results of earlier runs consulted before simulating (optional)
+  ResultCache *cache = nullptr;
+};
+
+/// \brief Runs two configurations over paired replications and reports the
+/// differences (b - a) of the headline metrics with 95% confidence intervals
+class Comparison {
+public:
+  enum Metric { IDLE_RATE, STATION_UTILIZATION, TRIPS, AVG_IDLE_TIME, COUNT };
+
+private:
+  SimConfig m_configA;
+  SimConfig m_configB;
+  ComparisonOptions m_options;
+  std::array<PairedDifference, COUNT> m_stats;
+  ThreadPool m_threadPool;
+
+  static std::array<double, COUNT> metricsOf(const SimResults &results) {
+    return {results.truckIdleRate(), results.stationUtilization(),
+            static_cast<double>(results.tripsCompleted),
+            results.numTrucks > 0 ? results.totalIdleTime / results.numTrucks
+                                  : 0.0};
+  }
+
+  // Queues the replications of a configuration on the pool: one task per
+  // lane batch, or per replication when the configuration cannot run on
+  // lanes. Every run stays on its worker's thread.
+  std::vector<std::future<std::vector<SimResults>>>
+  enqueue(SimConfig config, const std::vector<uint64_t> &seeds, bool antithetic) {
+    config.antithetic = antithetic;
+    config.numThreads = 1;
+    size_t batch = m_options.lanes > 0 && LaneSim<8>::supports(config) ? 8 : 1;
+    std::vector<std::future<std::vector<SimResults>>> futures;
+    for (size_t begin = 0; begin < seeds.size(); begin += batch) {
+      std::vector<uint64_t> chunk(
+          seeds.begin() + begin,
+          seeds.begin() + std::min(begin + batch, seeds.size()));
+      futures.push_back(m_threadPool.enqueue([this, config, chunk]() {
+        return runReplications(config, chunk, m_options.lanes, m_options.cache);
+      }));
+    }
+    return futures;
+  }
+
+  // Waits for queued replications and returns their metrics in seed order
+  static std::vector<std::array<double, COUNT>>
+  collect(std::vector<std::future<std::vector<SimResults>>> &futures) {
+    std::vector<std::array<double, COUNT>> metrics;
+    for (auto &future : futures) {
+      for (const SimResults &results : future.get()) {
+        metrics.push_back(metricsOf(results));
+      }
+    }
+    return metrics;
+  }
+
+  // Averages each replication with its antithetic twin
+  static void averageTwins(std::vector<std::array<double, COUNT>> &metrics,
+                           const std::vector<std::array<double, COUNT>> &twins) {
+    for (size_t r = 0; r < metrics.size(); ++r) {
+      for (size_t i = 0; i < COUNT; ++i) {
+        metrics[r][i] = 0.5 * (metrics[r][i] + twins[r][i]);
+      }
+    }
+  }
+
+public:
+  Comparison(const SimConfig &configA, const SimConfig &configB,
+             const ComparisonOptions &options)
+      : m_configA(configA), m_configB(configB), m_options(options),
+        m_threadPool(options.parallelism > 0
+                         ? options.parallelism
+                         : std::thread::hardware_concurrency()) {}
+
+  static const char *metricName(Metric metric) {
+    switch (metric) {
+    case IDLE_RATE:
+      return "Truck Idle Rate (%)";
+    case STATION_UTILIZATION:
+      return "Station Utilization (%)";
+    case TRIPS:
+      return "Trips Completed";
+    case AVG_IDLE_TIME:
+      return "Avg Idle Time (s)";
+    default:
+      return "";
+    }
+  }
+
+  const PairedDifference &getStats(Metric metric) const {
+    return m_stats[metric];
+  }
+
+  /// \brief Runs every replication of both configurations
+  void run() {
+    std::vector<uint64_t> seedsA;
+    std::vector<uint64_t> seedsB;
+    for (uint32_t r = 0; r < m_options.replications; ++r) {
+      uint64_t seedA = m_options.baseSeed + r;
+      // Without common random numbers configuration B gets its own streams
+      uint64_t seedB = m_options.commonRandomNumbers
+                           ? seedA
+                           : RandomStream::mix(seedA ^ 0xb5ad4eceda1ce2a9ULL);
+      seedsA.push_back(seedA);
+      seedsB.push_back(seedB);
+    }
+
+    // Both configurations (and their antithetic twins) share the pool, so
+    // the pairs run side by side
+    auto futuresA = enqueue(m_configA, seedsA, false);
+    auto futuresB = enqueue(m_configB, seedsB, false);
+    std::vector<std::future<std::vector<SimResults>>> twinsA, twinsB;
+    if (m_options.antithetic) {
+      twinsA = enqueue(m_configA, seedsA, true);
+      twinsB = enqueue(m_configB, seedsB, true);
+    }
+    std::vector<std::array<double, COUNT>> a = collect(futuresA);
+    std::vector<std::array<double, COUNT>> b = collect(futuresB);
+    if (m_options.antithetic) {
+      averageTwins(a, collect(twinsA));
+      averageTwins(b, collect(twinsB));
+    }
+    for (uint32_t r = 0; r < m_options.replications; ++r) {
+      for (size_t i = 0; i < COUNT; ++i) {
+        m_stats[i].add(a[r][i], b[r][i]);
+      }
+    }
+  }
+
+  /// \brief Prints the paired differences with their confidence intervals
+  void printReport() const {
+    std::cout << "=== PAIRED COMPARISON ===" << std::endl;
+    std::cout << "A: " << m_configA.numTrucks << " trucks, "
+              << m_configA.numStations << " stations, "
+              << dispatchRuleName(m_configA.dispatch) << " dispatch"
+              << std::endl;
+    std::cout << "B: " << m_configB.numTrucks << " trucks, "
+              << m_configB.numStations << " stations, "
+              << dispatchRuleName(m_configB.dispatch) << " dispatch"
+              << std::endl;
+    std::cout << "Replications: " << m_options.replications
+              << (m_options.antithetic ? " antithetic pairs" : "")
+              << ", common random numbers: "
+              << (m_options.commonRandomNumbers ? "on" : "off") << std::endl;
+    std::cout << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < COUNT; ++i) {
+      const PairedDifference &stats = m_stats[i];
+      double halfWidth = stats.getHalfWidth();
+      std::cout << metricName(static_cast<Metric>(i)) << ":" << std::endl;
+      std::cout << "  A mean: " << stats.getMeanA()
+                << "  B mean: " << stats.getMeanB() << std::endl;
+      std::cout << "  B - A: " << stats.getMeanDiff() << " +/- " << halfWidth
+                << " (95% CI [" << stats.getMeanDiff() - halfWidth << ", "
+                << stats.getMeanDiff() + halfWidth << "])" << std::endl;
+      std::cout << "  Std dev of difference: " << stats.getStdDev()
+                << std::endl;
+    }
+  }
+};
@@ -0,0 +1,125 @@
+#pragma once
+// Truck-to-station dispatch policies
+#include "Station.hpp"
+#include "Truck.hpp"
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+
+/// \brief Runtime selector of the dispatch policy
+enum class DispatchRule { FIFO, SHORTEST_QUEUE, LEAST_WAIT, ROUND_ROBIN };
+
+/// \brief View of the stations and their queues offered to a policy
+struct DispatchContext {
+  // Route result: wait in the shared queue for the first free station
+  static constexpr size_t ANY_STATION = std::numeric_limits<size_t>::max();
+
+  std::span<const Station> stations;
+  std::span<const std::deque<Truck *>> queues;
+};
+
+/// \brief A dispatch policy routes every truck arriving at the stations
+/// either to one station's queue, where it stays until that station is free,
+/// or to the shared queue served by whichever station frees up first. Both
+/// kinds of queues are served in arrival order.
+template <typename P>
+concept DispatchPolicy =
+    std::default_initializable<P> &&
+    requires(P policy, const Truck &truck, const DispatchContext &context) {
+      { policy.route(truck, context) } -> std::convertible_to<size_t>;
+      { P::NAME } -> std::convertible_to<const char *>;
+    };
+
+/// \brief Trucks are served by the first free station in arrival order
+struct FifoDispatch {
+  static constexpr const char *NAME = "fifo";
+
+  size_t route(const Truck &, const DispatchContext &) {
+    return DispatchContext::ANY_STATION;
+  }
+};
+
+/// \brief Trucks join the station with the fewest trucks (queued or in
+/// service) and remain in that queue
+struct ShortestQueueDispatch {
+  static constexpr const char *NAME = "shortest-queue";
+
+  size_t route(const Truck &, const DispatchContext &context) {
+    size_t best = 0;
+    size_t bestLength = std::numeric_limits<size_t>::max();
+    for (size_t i = 0; i < context.stations.size(); ++i) {
+      size_t length = context.queues[i].size() +
+                      (context.stations[i].getTruckInStation() ? 1 : 0);
+      if (length < bestLength) {
+        best = i;
+        bestLength = length;
+      }
+    }
+    return best;
+  }
+};
+
+/// \brief Trucks join the station whose queue clears first: the remaining
+/// unload of the truck in service plus a full unload per queued truck
+struct LeastWaitDispatch {
+  static constexpr const char *NAME = "least-wait";
+
+  size_t route(const Truck &, const DispatchContext &context) {
+    size_t best = 0;
+    float bestWait = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < context.stations.size(); ++i) {
+      float wait = context.stations[i].getServiceTimeLeft() +
+                   context.queues[i].size() * Truck::UNLOAD_TIME;
+      if (wait < bestWait) {
+        best = i;
+        bestWait = wait;
+      }
+    }
+    return best;
+  }
+};
+
+/// \brief Trucks reserve stations in cyclic order and wait for their
+/// reserved station
+struct RoundRobinDispatch {
+  static constexpr const char *NAME = "round-robin";
+
+  size_t m_next = 0;
+
+  size_t route(const Truck &, const DispatchContext &context) {
+    size_t station = m_next;
+    m_next = (m_next + 1) % context.stations.size();
+    return station;
+  }
+};
+
+/// \brief Retrieves the command-line name of a dispatch rule
+inline const char *dispatchRuleName(DispatchRule rule) {
+  switch (rule) {
+  case DispatchRule::SHORTEST_QUEUE:
+    return ShortestQueueDispatch::NAME;
+  case DispatchRule::LEAST_WAIT:
+    return LeastWaitDispatch::NAME;
+  case DispatchRule::ROUND_ROBIN:
+    return RoundRobinDispatch::NAME;
+  case DispatchRule::FIFO:
+  default:
+    return FifoDispatch::NAME;
+  }
+}
+
+/// \brief Parses the command-line name of a dispatch rule
+inline std::optional<DispatchRule> parseDispatchRule(const std::string &name) {
+  for (DispatchRule rule :
+       {DispatchRule::FIFO, DispatchRule::SHORTEST_QUEUE,
+        DispatchRule::LEAST_WAIT, DispatchRule::ROUND_ROBIN}) {
+    if (name == dispatchRuleName(rule)) {
+      return rule;
+    }
+  }
+  return std::nullopt;
+}
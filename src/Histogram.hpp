@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/// \brief Constant-memory log-bucketed histogram (HDR style).
+///
+/// Values below 2^SUB_BUCKET_BITS get one bucket each; above that every power
+/// of two is split into 2^(SUB_BUCKET_BITS - 1) linear sub-buckets, bounding
+/// the relative error of a reported percentile to under 1%. Recording never
+/// allocates, and histograms of the same layout merge by adding counts.
+class Histogram {
+public:
+  static constexpr unsigned SUB_BUCKET_BITS = 7;
+  static constexpr unsigned MAX_VALUE_BITS = 40;
+  static constexpr uint64_t MAX_VALUE = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+  static constexpr size_t HALF_SUB_BUCKETS = size_t(1) << (SUB_BUCKET_BITS - 1);
+  static constexpr size_t NUM_BUCKETS =
+      (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+
+private:
+  std::array<uint64_t, NUM_BUCKETS> m_counts{};
+  uint64_t m_totalCount = 0;
+  uint64_t m_min = std::numeric_limits<uint64_t>::max();
+  uint64_t m_max = 0;
+  double m_sum = 0.0;
+
+  static size_t bucketIndex(uint64_t value) {
+    if (value < (uint64_t(1) << SUB_BUCKET_BITS)) {
+      return static_cast<size_t>(value);
+    }
+    unsigned shift = std::bit_width(value) - SUB_BUCKET_BITS;
+    return (size_t(shift) << (SUB_BUCKET_BITS - 1)) +
+           static_cast<size_t>(value >> shift);
+  }
+
+  // Largest value that maps to the given bucket
+  static uint64_t bucketUpperBound(size_t index) {
+    if (index < (size_t(1) << SUB_BUCKET_BITS)) {
+      return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / HALF_SUB_BUCKETS) - 1;
+    uint64_t subBucket = index - shift * HALF_SUB_BUCKETS;
+    return (subBucket << shift) + (uint64_t(1) << shift) - 1;
+  }
+
+public:
+  /// \brief Records one value (clamped to MAX_VALUE)
+  void record(uint64_t value) {
+    value = std::min(value, MAX_VALUE);
+    m_counts[bucketIndex(value)]++;
+    m_totalCount++;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    m_sum += static_cast<double>(value);
+  }
+
+  /// \brief Records a duration in seconds, rounded to whole seconds
+  void recordSeconds(double seconds) {
+    record(seconds > 0.0 ? static_cast<uint64_t>(std::llround(seconds)) : 0);
+  }
+
+  /// \brief Adds the counts of another histogram to this one
+  void merge(const Histogram &other) {
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_totalCount += other.m_totalCount;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+  }
+
+  /// \brief Clears every recorded value
+  void reset() {
+    m_counts.fill(0);
+    m_totalCount = 0;
+    m_min = std::numeric_limits<uint64_t>::max();
+    m_max = 0;
+    m_sum = 0.0;
+  }
+
+  uint64_t getCount() const { return m_totalCount; }
+  uint64_t getMax() const { return m_max; }
+  uint64_t getMin() const { return m_totalCount > 0 ? m_min : 0; }
+
+  double getMean() const {
+    return m_totalCount > 0 ? m_sum / m_totalCount : 0.0;
+  }
+
+  /// \brief Retrieves the value at the given percentile (0-100)
+  uint64_t getPercentile(double percentile) const {
+    if (m_totalCount == 0) {
+      return 0;
+    }
+    double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    uint64_t rank = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(fraction * m_totalCount)), 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += m_counts[i];
+      if (seen >= rank) {
+        return std::min(bucketUpperBound(i), m_max);
+      }
+    }
+    return m_max;
+  }
+};
+
+/// \brief Percentile summary of a histogram, in seconds
+struct PercentileSummary {
+  uint64_t count = 0;
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t max = 0;
+
+  static PercentileSummary of(const Histogram &histogram) {
+    return {histogram.getCount(), histogram.getPercentile(50.0),
+            histogram.getPercentile(90.0), histogram.getPercentile(99.0),
+            histogram.getMax()};
+  }
+};
+
+/// \brief Per-trip histograms recorded by trucks. Each worker thread owns one
+/// instance, padded to its own cache lines, and the instances are merged
+/// once at the end of a run.
+struct alignas(64) TripHistograms {
+  Histogram queueWait; // per station visit, arrival to start of unloading
+  Histogram cycleTime; // per trip, start of mining to return to the site
+
+  void merge(const TripHistograms &other) {
+    queueWait.merge(other.queueWait);
+    cycleTime.merge(other.cycleTime);
+  }
+
+  void reset() {
+    queueWait.reset();
+    cycleTime.reset();
+  }
+};
@@ -0,0 +1,437 @@
+#pragma once
+// Lane-batched replications of small configurations
+#include "ResultCache.hpp"
+#include "ThreadPool.hpp"
+#include "TruckSim.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/// \brief Runs LANES replications of one configuration in lockstep, one seed
+/// per lane.
+///
+/// An event-stepped batch engine: every timer and counter is stored as an
+/// array over the lanes, and the lanes jump together from one event tick (a
+/// deadline or a station release in any lane) to the next; lanes without an
+/// event on that tick are left unchanged by their masks. The gain over
+/// scalar runs comes from sharing that event loop and skipping the ticks
+/// without events, not from SIMD: of the lane loops, only the search for
+/// the next event tick is vectorized by the compiler (-O3, 16-byte vectors);
+/// the per-truck state updates stay scalar.
+///
+/// Lane l produces exactly the totals of TruckSim with seed seeds[l]: same
+/// mining streams, tick semantics and FIFO order. Only what supports()
+/// accepts is modelled, and the results carry no percentile summaries.
+template <size_t LANES> class LaneSim {
+  using LaneI32 = std::array<int32_t, LANES>;
+  using LaneI64 = std::array<int64_t, LANES>;
+
+  static constexpr float dt = TruckSim::getTimeStep();
+  static constexpr int32_t NEVER = std::numeric_limits<int32_t>::max();
+  static constexpr int32_t MINING =
+      static_cast<int32_t>(TruckState::MINING);
+  static constexpr int32_t TO_STATION =
+      static_cast<int32_t>(TruckState::TRAVELING_TO_STATION);
+  static constexpr int32_t UNLOADING =
+      static_cast<int32_t>(TruckState::UNLOADING);
+  static constexpr int32_t TO_SITE =
+      static_cast<int32_t>(TruckState::TRAVELING_TO_SITE);
+  static constexpr int32_t IDLE = static_cast<int32_t>(TruckState::IDLE);
+
+  static int32_t ticksOf(float seconds) {
+    return static_cast<int32_t>(std::ceil(seconds / dt));
+  }
+  static inline const int32_t TRAVEL_TICKS = ticksOf(Truck::TRAVEL_TIME);
+  static inline const int32_t UNLOAD_TICKS = ticksOf(Truck::UNLOAD_TIME);
+
+  SimConfig m_config;
+  uint32_t m_numTrucks;
+  uint32_t m_numStations;
+  int32_t m_durationTicks;
+  int32_t m_warmupTicks;
+  int32_t m_statsStartTick = 0;
+
+  // Per truck: state, deadline of the timed state (NEVER while idle), first
+  // tick not yet accounted, tick of the last arrival at the stations,
+  // duration of the next mining period, stream position and stream key
+  std::vector<LaneI32> m_state;
+  std::vector<LaneI32> m_deadline;
+  std::vector<LaneI32> m_since;
+  std::vector<LaneI32> m_arrival;
+  std::vector<LaneI32> m_miningTicks;
+  std::vector<std::array<uint64_t, LANES>> m_draws;
+  std::vector<std::array<uint64_t, LANES>> m_keys;
+
+  // Per station: tick of the release (NEVER while free) and first occupied
+  // tick not yet accounted
+  std::vector<LaneI32> m_release;
+  std::vector<LaneI32> m_busySince;
+
+  // Per lane totals, in ticks
+  LaneI64 m_mining{};
+  LaneI64 m_unload{};
+  LaneI64 m_travel{};
+  LaneI64 m_idle{};
+  LaneI64 m_trips{};
+  LaneI64 m_occupied{};
+  LaneI32 m_waiting{};
+
+  // Draws the next mining duration of a truck in the lanes of the mask
+  void drawMining(uint32_t truck, const std::array<bool, LANES> &mask) {
+    for (size_t l = 0; l < LANES; ++l) {
+      if (mask[l]) {
+        double u = RandomStream::uniformOf(m_keys[truck][l], m_draws[truck][l]++);
+        if (m_config.antithetic) {
+          u = 1.0 - u;
+        }
+        m_miningTicks[truck][l] = ticksOf((int)Truck::miningTimeOf(u));
+      }
+    }
+  }
+
+  // Smallest deadline or release after the current tick, over every lane
+  int32_t nextEvent() const {
+    int32_t next = NEVER;
+    for (const LaneI32 &deadline : m_deadline) {
+      for (size_t l = 0; l < LANES; ++l) {
+        next = std::min(next, deadline[l]);
+      }
+    }
+    for (const LaneI32 &release : m_release) {
+      for (size_t l = 0; l < LANES; ++l) {
+        next = std::min(next, release[l]);
+      }
+    }
+    return next;
+  }
+
+  // Frees the stations whose unload ended on the previous tick
+  void releaseStations(int32_t tick) {
+    for (uint32_t s = 0; s < m_numStations; ++s) {
+      LaneI32 &release = m_release[s];
+      LaneI32 &busySince = m_busySince[s];
+      for (size_t l = 0; l < LANES; ++l) {
+        bool done = release[l] == tick;
+        m_occupied[l] += done ? tick - 1 - busySince[l] : 0;
+        release[l] = done ? NEVER : release[l];
+      }
+    }
+  }
+
+  // Ends the timed states due on this tick and enters the next ones
+  void expireTrucks(int32_t tick) {
+    for (uint32_t t = 0; t < m_numTrucks; ++t) {
+      LaneI32 &state = m_state[t];
+      LaneI32 &deadline = m_deadline[t];
+      LaneI32 &since = m_since[t];
+      LaneI32 &arrival = m_arrival[t];
+      const LaneI32 &miningTicks = m_miningTicks[t];
+
+      bool any = false;
+      bool anyMining = false;
+      std::array<bool, LANES> mined;
+      for (size_t l = 0; l < LANES; ++l) {
+        bool due = deadline[l] == tick;
+        mined[l] = due && state[l] == MINING;
+        any |= due;
+        anyMining |= mined[l];
+      }
+      if (!any) {
+        continue;
+      }
+      if (anyMining) {
+        drawMining(t, mined);
+      }
+
+      for (size_t l = 0; l < LANES; ++l) {
+        bool due = deadline[l] == tick;
+        int32_t s = state[l];
+        int32_t elapsed = due ? tick - since[l] : 0;
+        m_mining[l] += s == MINING ? elapsed : 0;
+        m_travel[l] += (s == TO_STATION || s == TO_SITE) ? elapsed : 0;
+        m_unload[l] += s == UNLOADING ? elapsed : 0;
+        m_trips[l] += (due && s == UNLOADING) ? 1 : 0;
+        m_waiting[l] += (due && s == TO_STATION) ? 1 : 0;
+
+        // Arrivals wait (idle) for a station from this tick on
+        int32_t next = s == MINING      ? TO_STATION
+                       : s == TO_STATION ? IDLE
+                       : s == UNLOADING  ? TO_SITE
+                                         : MINING;
+        int32_t nextDeadline = s == TO_STATION ? NEVER
+                               : s == TO_SITE  ? tick + miningTicks[l]
+                                               : tick + TRAVEL_TICKS;
+        state[l] = due ? next : s;
+        deadline[l] = due ? nextDeadline : deadline[l];
+        since[l] = due ? tick : since[l];
+        arrival[l] = (due && s == TO_STATION) ? tick : arrival[l];
+      }
+    }
+  }
+
+  // Every free station takes the truck that has waited longest (lowest id
+  // first among trucks that arrived on the same tick)
+  void assignTrucks(int32_t tick) {
+    for (uint32_t s = 0; s < m_numStations; ++s) {
+      LaneI32 &release = m_release[s];
+      bool any = false;
+      for (size_t l = 0; l < LANES; ++l) {
+        any |= release[l] == NEVER && m_waiting[l] > 0;
+      }
+      if (!any) {
+        continue;
+      }
+
+      LaneI32 best;
+      LaneI32 bestArrival;
+      best.fill(-1);
+      bestArrival.fill(NEVER);
+      for (uint32_t t = 0; t < m_numTrucks; ++t) {
+        const LaneI32 &state = m_state[t];
+        const LaneI32 &arrival = m_arrival[t];
+        for (size_t l = 0; l < LANES; ++l) {
+          bool earlier = state[l] == IDLE && arrival[l] < bestArrival[l];
+          best[l] = earlier ? static_cast<int32_t>(t) : best[l];
+          bestArrival[l] = earlier ? arrival[l] : bestArrival[l];
+        }
+      }
+
+      std::array<bool, LANES> take;
+      for (size_t l = 0; l < LANES; ++l) {
+        take[l] = release[l] == NEVER && best[l] >= 0;
+        release[l] = take[l] ? tick + UNLOAD_TICKS + 1 : release[l];
+        m_busySince[s][l] = take[l] ? tick : m_busySince[s][l];
+        m_waiting[l] -= take[l] ? 1 : 0;
+      }
+      for (uint32_t t = 0; t < m_numTrucks; ++t) {
+        LaneI32 &state = m_state[t];
+        LaneI32 &deadline = m_deadline[t];
+        LaneI32 &since = m_since[t];
+        for (size_t l = 0; l < LANES; ++l) {
+          bool chosen = take[l] && best[l] == static_cast<int32_t>(t);
+          m_idle[l] += chosen ? tick - since[l] : 0;
+          state[l] = chosen ? UNLOADING : state[l];
+          deadline[l] = chosen ? tick + UNLOAD_TICKS : deadline[l];
+          since[l] = chosen ? tick : since[l];
+        }
+      }
+    }
+  }
+
+  // Accounts every open state and station visit up to a tick
+  void accountOpen(int32_t tick) {
+    for (uint32_t t = 0; t < m_numTrucks; ++t) {
+      const LaneI32 &state = m_state[t];
+      LaneI32 &since = m_since[t];
+      for (size_t l = 0; l < LANES; ++l) {
+        int32_t s = state[l];
+        int32_t elapsed = tick - since[l];
+        m_mining[l] += s == MINING ? elapsed : 0;
+        m_travel[l] += (s == TO_STATION || s == TO_SITE) ? elapsed : 0;
+        m_unload[l] += s == UNLOADING ? elapsed : 0;
+        m_idle[l] += s == IDLE ? elapsed : 0;
+        since[l] = tick;
+      }
+    }
+    for (uint32_t s = 0; s < m_numStations; ++s) {
+      const LaneI32 &release = m_release[s];
+      LaneI32 &busySince = m_busySince[s];
+      for (size_t l = 0; l < LANES; ++l) {
+        bool busy = release[l] != NEVER;
+        m_occupied[l] += busy ? tick - busySince[l] : 0;
+        busySince[l] = busy ? tick : busySince[l];
+      }
+    }
+  }
+
+  // Discards everything accumulated so far (end of the warm-up period)
+  void resetStatistics(int32_t tick) {
+    accountOpen(tick);
+    m_mining.fill(0);
+    m_unload.fill(0);
+    m_travel.fill(0);
+    m_idle.fill(0);
+    m_trips.fill(0);
+    m_occupied.fill(0);
+    m_statsStartTick = tick;
+  }
+
+public:
+  /// \brief Returns whether a configuration can run on lanes: FIFO dispatch,
+  /// random mining durations, a fixed warm-up and a horizon that fits the
+  /// 32-bit tick timers
+  static bool supports(const SimConfig &config) {
+    double limit = std::numeric_limits<int32_t>::max() / 2.0 * dt;
+    return config.dispatch == DispatchRule::FIFO && !config.trace &&
+           !config.autoWarmup && config.horizonSecs < limit &&
+           config.warmupSecs < limit;
+  }
+
+  // Constructor
+  // \param config The configuration replicated on every lane (its seed is
+  // ignored). Must be supported.
+  // \param seeds Seed of each lane.
+  LaneSim(const SimConfig &config, const std::array<uint64_t, LANES> &seeds)
+      : m_config(config), m_numTrucks(config.numTrucks),
+        m_numStations(config.numStations),
+        m_durationTicks(static_cast<int32_t>(std::llround(config.horizonSecs / dt))),
+        m_warmupTicks(static_cast<int32_t>(std::llround(config.warmupSecs / dt))),
+        m_state(m_numTrucks), m_deadline(m_numTrucks),
+        m_since(m_numTrucks), m_arrival(m_numTrucks), m_miningTicks(m_numTrucks),
+        m_draws(m_numTrucks), m_keys(m_numTrucks), m_release(m_numStations),
+        m_busySince(m_numStations) {
+    std::array<bool, LANES> all;
+    all.fill(true);
+    for (uint32_t t = 0; t < m_numTrucks; ++t) {
+      m_state[t].fill(MINING);
+      m_since[t].fill(0);
+      m_arrival[t].fill(0);
+      m_draws[t].fill(0);
+      for (size_t l = 0; l < LANES; ++l) {
+        m_keys[t][l] = RandomStream::keyOf(seeds[l], t);
+      }
+      drawMining(t, all);
+      m_deadline[t] = m_miningTicks[t];
+    }
+    for (uint32_t s = 0; s < m_numStations; ++s) {
+      m_release[s].fill(NEVER);
+      m_busySince[s].fill(0);
+    }
+  }
+
+  /// \brief Runs every lane to the horizon and returns their totals, in
+  /// lane order
+  std::vector<SimResults> run() {
+    int32_t tick = 0;
+    while (tick < m_durationTicks) {
+      int32_t next = std::min(nextEvent(), m_durationTicks);
+      if (m_warmupTicks > tick) {
+        next = std::min(next, m_warmupTicks);
+      }
+      tick = next;
+      if (m_config.cancel && m_config.cancel->load(std::memory_order_relaxed)) {
+        throw SimulationCancelled();
+      }
+
+      releaseStations(tick);
+      expireTrucks(tick);
+      assignTrucks(tick);
+      if (tick == m_warmupTicks) {
+        resetStatistics(tick);
+      }
+    }
+    accountOpen(m_durationTicks);
+
+    std::vector<SimResults> results(LANES);
+    double measuredSecs = (m_durationTicks - m_statsStartTick) * dt;
+    for (size_t l = 0; l < LANES; ++l) {
+      SimResults &lane = results[l];
+      lane.numTrucks = m_numTrucks;
+      lane.numStations = m_numStations;
+      lane.durationSecs = measuredSecs;
+      lane.warmupSecs = m_statsStartTick * dt;
+      lane.totalMiningTime = m_mining[l] * dt;
+      lane.totalUnloadTime = m_unload[l] * dt;
+      lane.totalTravelTime = m_travel[l] * dt;
+      lane.totalIdleTime = m_idle[l] * dt;
+      lane.totalStationOccupiedTime = m_occupied[l] * dt;
+      lane.tripsCompleted = static_cast<uint64_t>(m_trips[l]);
+      lane.hasPercentiles = false;
+    }
+    return results;
+  }
+};
+
+/// \brief Runs one replication of a configuration per seed and returns the
+/// results in seed order. Supported configurations run in batches of 8 on
+/// LaneSim<8>, the rest, or all of them with lanes == 0, as scalar TruckSim
+/// runs.
+/// Every run stays on one thread; with a pool (not called from one of its
+/// workers), the batches or scalar runs are spread across it. With a cache,
+/// only the seeds it does not hold are simulated, and their results are
+/// added to it.
+inline std::vector<SimResults> runReplications(SimConfig config,
+                                               const std::vector<uint64_t> &seeds,
+                                               uint32_t lanes = 8,
+                                               ResultCache *cache = nullptr,
+                                               ThreadPool *pool = nullptr) {
+  config.quiet = true;
+  // Replications are the parallelism; a pool per run would only be built
+  // and joined for nothing
+  config.numThreads = 1;
+  if (cache != nullptr) {
+    std::vector<std::optional<SimResults>> cached;
+    std::vector<uint64_t> missing;
+    for (uint64_t seed : seeds) {
+      config.seed = seed;
+      cached.push_back(cache->find(config));
+      if (!cached.back()) {
+        missing.push_back(seed);
+      }
+    }
+
+    std::vector<SimResults> computed =
+        runReplications(config, missing, lanes, nullptr, pool);
+    std::vector<SimResults> results;
+    results.reserve(seeds.size());
+    size_t next = 0;
+    for (size_t i = 0; i < seeds.size(); ++i) {
+      if (!cached[i]) {
+        config.seed = seeds[i];
+        cache->insert(config, computed[next]);
+        cached[i] = computed[next++];
+      }
+      results.push_back(*cached[i]);
+    }
+    return results;
+  }
+
+  size_t width = lanes > 0 && LaneSim<8>::supports(config) ? 8 : 1;
+
+  // Runs the replications of seeds [begin, begin + count), count <= width
+  auto runGroup = [config, width, &seeds](size_t begin, size_t count) {
+    if (width == 8) {
+      // A partial batch repeats its last seed in the unused lanes
+      std::array<uint64_t, 8> batch;
+      for (size_t l = 0; l < batch.size(); ++l) {
+        batch[l] = seeds[std::min(begin + l, seeds.size() - 1)];
+      }
+      std::vector<SimResults> lane = LaneSim<8>(config, batch).run();
+      lane.resize(count);
+      return lane;
+    }
+    SimConfig scalar = config;
+    scalar.seed = seeds[begin];
+    return std::vector<SimResults>{TruckSim(scalar).run()};
+  };
+
+  std::vector<std::pair<size_t, size_t>> groups;
+  for (size_t begin = 0; begin < seeds.size(); begin += width) {
+    groups.emplace_back(begin, std::min(width, seeds.size() - begin));
+  }
+
+  std::vector<SimResults> results;
+  results.reserve(seeds.size());
+  if (pool == nullptr || groups.size() < 2) {
+    for (const auto &[begin, count] : groups) {
+      std::vector<SimResults> group = runGroup(begin, count);
+      results.insert(results.end(), group.begin(), group.end());
+    }
+    return results;
+  }
+  std::vector<std::future<std::vector<SimResults>>> futures;
+  futures.reserve(groups.size());
+  for (const auto &[begin, count] : groups) {
+    futures.push_back(pool->enqueue(runGroup, begin, count));
+  }
+  for (auto &future : futures) {
+    std::vector<SimResults> group = future.get();
+    results.insert(results.end(), group.begin(), group.end());
+  }
+  return results;
+}
@@ -0,0 +1,170 @@
+#pragma once
+// Recorded mining durations, replayed instead of random draws
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+/// \brief Read-only memory-mapped file of per-truck mining durations.
+///
+/// Layout (native little-endian):
+///   char     magic[8]               "MSTRACE1"
+///   uint32_t version                1
+///   uint32_t numTrucks
+///   uint64_t offsets[numTrucks + 1] start of each truck's sequence, in
+///                                   durations; the last entry is the total
+///   float    durations[]            seconds, in cycle order, within
+///                                   [MIN_DURATION, MAX_DURATION]
+///
+/// Truck i of a fleet replays sequence i % numTrucks and wraps around at its
+/// end. The mapping is shared by every run holding the trace.
+class MiningTrace {
+  static constexpr char MAGIC[8] = {'M', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+  static constexpr uint32_t VERSION = 1;
+
+public:
+  // Accepted durations: at least one time step of the engine (1 s), so a
+  // mining period always ends on a later tick, and at most 30 days, far
+  // within the tick range of a truck
+  static constexpr float MIN_DURATION = 1.0f;
+  static constexpr float MAX_DURATION = 30.0f * 24.0f * 3600.0f;
+
+private:
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t numTrucks;
+  };
+
+  void *m_data = MAP_FAILED;
+  size_t m_size = 0;
+  uint32_t m_numTrucks = 0;
+  const uint64_t *m_offsets = nullptr;
+  const float *m_durations = nullptr;
+
+  void fail(const std::string &path, const std::string &reason) {
+    if (m_data != MAP_FAILED) {
+      munmap(m_data, m_size);
+      m_data = MAP_FAILED;
+    }
+    throw std::runtime_error("Invalid mining trace " + path + ": " + reason);
+  }
+
+public:
+  // Constructor
+  // \param path The trace file to map.
+  explicit MiningTrace(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open mining trace " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+      close(fd);
+      fail(path, "truncated header");
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_data == MAP_FAILED) {
+      throw std::runtime_error("Cannot map mining trace " + path);
+    }
+
+    const auto *bytes = static_cast<const unsigned char *>(m_data);
+    Header header;
+    std::memcpy(&header, bytes, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+      fail(path, "bad magic");
+    }
+    if (header.version != VERSION) {
+      fail(path, "unsupported version " + std::to_string(header.version));
+    }
+    if (header.numTrucks == 0) {
+      fail(path, "no trucks");
+    }
+    m_numTrucks = header.numTrucks;
+
+    size_t offsetsBytes = (size_t(m_numTrucks) + 1) * sizeof(uint64_t);
+    if (m_size < sizeof(Header) + offsetsBytes) {
+      fail(path, "truncated offsets");
+    }
+    m_offsets = reinterpret_cast<const uint64_t *>(bytes + sizeof(Header));
+    m_durations =
+        reinterpret_cast<const float *>(bytes + sizeof(Header) + offsetsBytes);
+
+    // Bounded before multiplying, so a forged total cannot wrap around
+    uint64_t total = m_offsets[m_numTrucks];
+    size_t durationsBytes = m_size - sizeof(Header) - offsetsBytes;
+    if (m_offsets[0] != 0 || total > durationsBytes / sizeof(float) ||
+        durationsBytes != total * sizeof(float)) {
+      fail(path, "size does not match the offsets");
+    }
+    for (uint32_t i = 0; i < m_numTrucks; ++i) {
+      if (m_offsets[i + 1] <= m_offsets[i]) {
+        fail(path, "empty sequence for truck " + std::to_string(i));
+      }
+    }
+    for (uint64_t i = 0; i < total; ++i) {
+      // Also rejects NaN, for which every comparison is false
+      if (!(m_durations[i] >= MIN_DURATION && m_durations[i] <= MAX_DURATION)) {
+        fail(path, "duration out of range at index " + std::to_string(i));
+      }
+    }
+  }
+
+  ~MiningTrace() {
+    if (m_data != MAP_FAILED) {
+      munmap(m_data, m_size);
+    }
+  }
+
+  MiningTrace(const MiningTrace &) = delete;
+  MiningTrace &operator=(const MiningTrace &) = delete;
+
+  /// \brief Retrieves the number of recorded trucks
+  uint32_t getNumTrucks() const { return m_numTrucks; }
+
+  /// \brief Retrieves the mining durations (seconds) of a recorded truck
+  std::span<const float> getDurations(uint32_t truck) const {
+    return {m_durations + m_offsets[truck],
+            m_durations + m_offsets[truck + 1]};
+  }
+
+  /// \brief Writes per-truck duration sequences (seconds) as a trace file
+  static void write(const std::string &path,
+                    const std::vector<std::vector<float>> &sequences) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numTrucks = static_cast<uint32_t>(sequences.size());
+
+    std::vector<uint64_t> offsets{0};
+    for (const auto &sequence : sequences) {
+      offsets.push_back(offsets.back() + sequence.size());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Cannot write mining trace " + path);
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(offsets.data()),
+              offsets.size() * sizeof(uint64_t));
+    for (const auto &sequence : sequences) {
+      out.write(reinterpret_cast<const char *>(sequence.data()),
+                sequence.size() * sizeof(float));
+    }
+    if (!out) {
+      throw std::runtime_error("Cannot write mining trace " + path);
+    }
+  }
+};
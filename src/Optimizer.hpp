@@ -0,0 +1,288 @@
+#pragma once
+// Simulation-based search for the smallest fleet or station count meeting
+// a service target
+#include "ThreadPool.hpp"
+#include "LaneSim.hpp"
+#include "TruckSim.hpp"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <vector>
+
+/// \brief Quantity minimized by the optimizer; the other one stays fixed
+enum class OptimizeTarget { STATIONS, TRUCKS };
+
+/// \brief Service targets a configuration has to meet
+struct OptimizerConstraints {
+  std::optional<double> maxIdleRate;             // % of truck time
+  std::optional<double> minStationUtilization;   // % of station time
+  std::optional<double> minThroughputPerStation; // trips per station
+};
+
+/// \brief Search settings of the optimizer
+struct OptimizerOptions {
+  OptimizeTarget target = OptimizeTarget::STATIONS;
+  uint32_t lowerBound = 1;
+  uint32_t upperBound = 0; // 0 picks a default from the fixed quantity
+  uint32_t replications = 5;
+  uint64_t baseSeed = 1;
+  uint32_t parallelism = 0; // 0 means use hardware_concurrency
+  // Replications batched per LaneSim run (8) by the default
+  // evaluator, 0 runs them one by one
+  uint32_t lanes = 8;
+  // Results of earlier runs consulted by the default evaluator (optional)
+  ResultCache *cache = nullptr;
+};
+
+/// \brief Replication means of the constrained metrics at one search point
+struct Evaluation {
+  uint32_t value = 0;
+  double idleRate = 0.0;
+  double stationUtilization = 0.0;
+  double throughputPerStation = 0.0;
+};
+
+/// \brief Finds the minimum number of stations (or trucks) that satisfies the
+/// constraints.
+///
+/// Every constraint is monotone in the searched quantity: adding stations
+/// lowers idle rate, utilization and throughput per station, adding trucks
+/// raises all three. The constraints that improve as the value grows define
+/// the smallest feasible value, which is found by a parallel multisection
+/// search; the remaining constraints are then checked at that value since
+/// they only get worse above it. Every replication of a search point uses
+/// the seeds baseSeed + r, so points are compared under common random numbers,
+/// and evaluations are cached so no point is simulated twice.
+class Optimizer {
+public:
+  using Evaluator = std::function<SimResults(const SimConfig &)>;
+
+private:
+  SimConfig m_base;
+  OptimizerConstraints m_constraints;
+  OptimizerOptions m_options;
+  Evaluator m_evaluator; // empty for the default (batched) evaluation
+  ThreadPool m_threadPool;
+  std::map<uint32_t, Evaluation> m_evaluations;
+  uint32_t m_simulationsRun = 0;
+
+  SimConfig configFor(uint32_t value, uint64_t seed) const {
+    SimConfig config = m_base;
+    if (m_options.target == OptimizeTarget::STATIONS) {
+      config.numStations = value;
+    } else {
+      config.numTrucks = value;
+    }
+    config.seed = seed;
+    config.antithetic = false;
+    config.quiet = true;
+    // Search points run in parallel, so each simulation stays on one thread
+    config.numThreads = 1;
+    return config;
+  }
+
+  // Constraints that become easier to meet as the searched value grows
+  bool satisfiesUpward(const Evaluation &eval) const {
+    bool stations = m_options.target == OptimizeTarget::STATIONS;
+    if (stations) {
+      return !m_constraints.maxIdleRate ||
+             eval.idleRate <= *m_constraints.maxIdleRate;
+    }
+    return (!m_constraints.minStationUtilization ||
+            eval.stationUtilization >= *m_constraints.minStationUtilization) &&
+           (!m_constraints.minThroughputPerStation ||
+            eval.throughputPerStation >=
+                *m_constraints.minThroughputPerStation);
+  }
+
+  // Constraints that only get harder to meet as the searched value grows
+  bool satisfiesDownward(const Evaluation &eval) const {
+    bool stations = m_options.target == OptimizeTarget::STATIONS;
+    if (stations) {
+      return (!m_constraints.minStationUtilization ||
+              eval.stationUtilization >=
+                  *m_constraints.minStationUtilization) &&
+             (!m_constraints.minThroughputPerStation ||
+              eval.throughputPerStation >=
+                  *m_constraints.minThroughputPerStation);
+    }
+    return !m_constraints.maxIdleRate ||
+           eval.idleRate <= *m_constraints.maxIdleRate;
+  }
+
+  // Evaluates every uncached value, running all replications in parallel
+  void evaluate(const std::vector<uint32_t> &values) {
+    std::vector<uint32_t> pending;
+    for (uint32_t value : values) {
+      if (m_evaluations.find(value) == m_evaluations.end() &&
+          std::find(pending.begin(), pending.end(), value) == pending.end()) {
+        pending.push_back(value);
+      }
+    }
+
+    // The default evaluation runs a batch of replications per task when the
+    // point can run on lanes, so small points fill the lanes of a LaneSim
+    // run; otherwise every replication stays a task of its own
+    std::vector<uint32_t> batches;
+    std::vector<std::future<std::vector<SimResults>>> futures;
+    for (uint32_t value : pending) {
+      SimConfig base = configFor(value, m_options.baseSeed);
+      uint32_t batch =
+          !m_evaluator && m_options.lanes > 0 && LaneSim<8>::supports(base)
+              ? 8
+              : 1;
+      batches.push_back(batch);
+      for (uint32_t r = 0; r < m_options.replications; r += batch) {
+        std::vector<uint64_t> seeds;
+        for (uint32_t i = r; i < std::min(r + batch, m_options.replications); ++i) {
+          seeds.push_back(m_options.baseSeed + i);
+        }
+        SimConfig config = configFor(value, seeds.front());
+        futures.push_back(m_threadPool.enqueue([this, config, seeds]() {
+          if (m_evaluator) {
+            return std::vector<SimResults>{m_evaluator(config)};
+          }
+          return runReplications(config, seeds, m_options.lanes,
+                                 m_options.cache);
+        }));
+      }
+    }
+
+    size_t next = 0;
+    for (size_t p = 0; p < pending.size(); ++p) {
+      uint32_t value = pending[p];
+      Evaluation eval;
+      eval.value = value;
+      for (uint32_t r = 0; r < m_options.replications; r += batches[p]) {
+        for (const SimResults &results : futures[next++].get()) {
+          eval.idleRate += results.truckIdleRate();
+          eval.stationUtilization += results.stationUtilization();
+          eval.throughputPerStation += results.throughputPerStation();
+        }
+      }
+      eval.idleRate /= m_options.replications;
+      eval.stationUtilization /= m_options.replications;
+      eval.throughputPerStation /= m_options.replications;
+      m_evaluations[value] = eval;
+      m_simulationsRun += m_options.replications;
+    }
+  }
+
+public:
+  Optimizer(const SimConfig &base, const OptimizerConstraints &constraints,
+            const OptimizerOptions &options, Evaluator evaluator = nullptr)
+      : m_base(base), m_constraints(constraints), m_options(options),
+        m_evaluator(std::move(evaluator)),
+        m_threadPool(options.parallelism > 0
+                         ? options.parallelism
+                         : std::thread::hardware_concurrency()) {
+    m_options.replications = std::max<uint32_t>(m_options.replications, 1);
+    m_options.lowerBound = std::max<uint32_t>(m_options.lowerBound, 1);
+    if (m_options.upperBound == 0) {
+      // More stations than trucks can never help; trucks default to a
+      // generous multiple of the station count
+      m_options.upperBound = m_options.target == OptimizeTarget::STATIONS
+                                 ? m_base.numTrucks
+                                 : 64 * m_base.numStations;
+    }
+    m_options.upperBound =
+        std::max(m_options.upperBound, m_options.lowerBound);
+  }
+
+  /// \brief Runs the search and returns the smallest feasible value, if any
+  std::optional<uint32_t> solve() {
+    uint32_t lo = m_options.lowerBound;
+    uint32_t hi = m_options.upperBound;
+
+    evaluate({lo, hi});
+    if (!satisfiesUpward(m_evaluations[hi])) {
+      return std::nullopt;
+    }
+
+    // Invariant: hi satisfies the upward constraints and lo does not
+    if (!satisfiesUpward(m_evaluations[lo])) {
+      uint32_t probes = std::max<uint32_t>(
+          static_cast<uint32_t>(m_threadPool.size()) / m_options.replications,
+          1);
+      while (hi - lo > 1) {
+        // Split (lo, hi) into probes + 1 parts and evaluate the cut points
+        std::vector<uint32_t> points;
+        uint32_t width = hi - lo;
+        for (uint32_t k = 1; k <= probes; ++k) {
+          uint32_t point = lo + static_cast<uint32_t>(
+                                    (static_cast<uint64_t>(width) * k) /
+                                    (probes + 1));
+          if (point > lo && point < hi &&
+              (points.empty() || points.back() != point)) {
+            points.push_back(point);
+          }
+        }
+        if (points.empty()) {
+          points.push_back(lo + width / 2);
+        }
+        evaluate(points);
+
+        for (uint32_t point : points) {
+          if (satisfiesUpward(m_evaluations[point])) {
+            hi = point;
+            break;
+          }
+          lo = point;
+        }
+      }
+    } else {
+      hi = lo;
+    }
+
+    if (!satisfiesDownward(m_evaluations[hi])) {
+      return std::nullopt;
+    }
+    return hi;
+  }
+
+  /// \brief Retrieves the number of simulations run so far
+  uint32_t getSimulationsRun() const { return m_simulationsRun; }
+
+  /// \brief Retrieves every evaluated search point, ordered by value
+  const std::map<uint32_t, Evaluation> &getEvaluations() const {
+    return m_evaluations;
+  }
+
+  /// \brief Prints the evaluated points and the outcome of the search
+  void printReport(const std::optional<uint32_t> &solution) const {
+    bool stations = m_options.target == OptimizeTarget::STATIONS;
+    const char *name = stations ? "Stations" : "Trucks";
+
+    std::cout << "=== OPTIMIZATION ===" << std::endl;
+    std::cout << "Minimizing: " << name << " (" << m_options.lowerBound
+              << " to " << m_options.upperBound << ")" << std::endl;
+    if (stations) {
+      std::cout << "Fixed Trucks: " << m_base.numTrucks << std::endl;
+    } else {
+      std::cout << "Fixed Stations: " << m_base.numStations << std::endl;
+    }
+    std::cout << "Replications per point: " << m_options.replications
+              << std::endl;
+    std::cout << std::endl;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Evaluated points:" << std::endl;
+    for (const auto &[value, eval] : m_evaluations) {
+      std::cout << name << " " << value << ": idle rate " << eval.idleRate
+                << "%, station utilization " << eval.stationUtilization
+                << "%, throughput/station " << eval.throughputPerStation
+                << std::endl;
+    }
+    std::cout << std::endl;
+
+    if (solution) {
+      std::cout << "Minimum " << name << ": " << *solution << std::endl;
+    } else {
+      std::cout << "No feasible value in range" << std::endl;
+    }
+    std::cout << "Simulations run: " << m_simulationsRun << std::endl;
+  }
+};
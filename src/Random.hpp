@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <random>
+
+/// \brief Counter-based random stream keyed by (seed, stream id).
+///
+/// The n-th draw of a stream depends only on the seed, the stream id and n,
+/// so two simulations built with the same seed see the same sequence for a
+/// given truck no matter how the rest of the fleet behaves (common random
+/// numbers). An antithetic stream returns 1 - u for every draw u of its twin.
+class RandomStream {
+  uint64_t m_key;
+  uint64_t m_counter = 0;
+  bool m_antithetic;
+
+public:
+  // Constructor
+  // \param seed The simulation-wide seed.
+  // \param streamId Identifier of the stream (e.g. the truck id).
+  // \param antithetic Whether draws are mirrored (1 - u).
+  RandomStream(uint64_t seed, uint64_t streamId, bool antithetic = false)
+      : m_key(keyOf(seed, streamId)), m_antithetic(antithetic) {}
+
+  /// \brief SplitMix64 finalizer, a cheap bijective 64-bit mixer
+  static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  /// \brief Retrieves the key of the stream (seed, streamId)
+  static uint64_t keyOf(uint64_t seed, uint64_t streamId) {
+    return mix(seed ^ mix(streamId + 0x9e3779b97f4a7c15ULL));
+  }
+
+  /// \brief Retrieves the uniform in [0, 1) at a position of a keyed stream,
+  /// before any mirroring
+  static double uniformOf(uint64_t key, uint64_t index) {
+    return (mix(key ^ mix(index)) >> 11) * 0x1.0p-53;
+  }
+
+  /// \brief Returns a fresh non-deterministic seed
+  static uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  }
+
+  /// \brief Retrieves the uniform in [0, 1) at the given position
+  double uniformAt(uint64_t index) const {
+    double u = uniformOf(m_key, index);
+    return m_antithetic ? 1.0 - u : u;
+  }
+
+  /// \brief Retrieves the next uniform of the stream
+  double nextUniform() { return uniformAt(m_counter++); }
+
+  /// \brief Retrieves the number of draws taken so far
+  uint64_t getCounter() const { return m_counter; }
+
+  /// \brief Returns whether the stream mirrors its draws
+  bool isAntithetic() const { return m_antithetic; }
+};
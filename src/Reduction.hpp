@@ -0,0 +1,65 @@
+#pragma once
+// Compensated sums and chunked reductions on the thread pool
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <vector>
+
+/// \brief Running double sum with Neumaier compensation, so totals over
+/// millions of terms do not drift
+class KahanSum {
+  double m_sum = 0.0;
+  double m_compensation = 0.0;
+
+public:
+  /// \brief Adds one term
+  void add(double value) {
+    double sum = m_sum + value;
+    if (std::abs(m_sum) >= std::abs(value)) {
+      m_compensation += (m_sum - sum) + value;
+    } else {
+      m_compensation += (value - sum) + m_sum;
+    }
+    m_sum = sum;
+  }
+
+  /// \brief Adds another compensated sum (e.g. of another chunk)
+  KahanSum &operator+=(const KahanSum &other) {
+    add(other.m_sum);
+    m_compensation += other.m_compensation;
+    return *this;
+  }
+
+  /// \brief Retrieves the compensated total
+  double get() const { return m_sum + m_compensation; }
+};
+
+/// \brief Reduces [0, count) as contiguous chunks, one per worker of the pool
+/// (or inline without a pool or below two grains of work). Each chunk is
+/// mapped to a partial with map(begin, end) and the partials are combined in
+/// chunk order with combine(total, partial), so the result only depends on
+/// the number of chunks.
+template <typename T, typename Map, typename Combine>
+T parallelReduce(ThreadPool *pool, size_t count, size_t grain, Map &&map,
+                 Combine &&combine) {
+  size_t numChunks =
+      pool ? std::min(pool->size(), count / std::max<size_t>(grain, 1)) : 0;
+  if (numChunks < 2) {
+    return map(size_t(0), count);
+  }
+
+  size_t chunkSize = (count + numChunks - 1) / numChunks;
+  std::vector<std::future<T>> partials;
+  partials.reserve(numChunks);
+  for (size_t begin = 0; begin < count; begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, count);
+    partials.push_back(pool->enqueue([&map, begin, end]() { return map(begin, end); }));
+  }
+
+  T total = partials.front().get();
+  for (size_t i = 1; i < partials.size(); ++i) {
+    combine(total, partials[i].get());
+  }
+  return total;
+}
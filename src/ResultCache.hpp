@@ -0,0 +1,399 @@
+#pragma once
+// Persistent cache of simulation results, keyed by configuration
+#include "TruckSim.hpp"
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/// \brief 128-bit identity of the results of a configuration
+struct CacheKey {
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+
+  bool operator==(const CacheKey &other) const = default;
+};
+
+struct CacheKeyHash {
+  size_t operator()(const CacheKey &key) const {
+    return static_cast<size_t>(key.lo);
+  }
+};
+
+/// \brief On-disk cache of SimResults shared across runs and processes.
+///
+/// Only deterministic configurations (seeded, without a trace) are cached.
+/// The key hashes every field that affects the results together with
+/// ENGINE_VERSION, so results of an older engine are never returned; thread
+/// count, logging and report options are left out.
+///
+/// Layout (native little-endian): a header
+///   char     magic[8]     "MSCACHE1"
+///   uint32_t version      1
+///   uint32_t recordSize   sizeof(Record)
+/// followed by fixed-size records, only ever appended (one write(2) each on
+/// an O_APPEND descriptor, so concurrent writers do not interleave). The file
+/// is memory-mapped to index the records; a later record of a key overrides
+/// an earlier one unless it lacks percentiles the earlier one has. A new,
+/// invalid or compacted file is written aside and renamed over the old one,
+/// so readers never see a partial header.
+class ResultCache {
+  static constexpr char MAGIC[8] = {'M', 'S', 'C', 'A', 'C', 'H', 'E', '1'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+  };
+
+  struct Record {
+    uint64_t keyHi;
+    uint64_t keyLo;
+    uint32_t numTrucks;
+    uint32_t numStations;
+    uint32_t hasPercentiles;
+    uint32_t reserved;
+    double durationSecs;
+    double warmupSecs;
+    double totalMiningTime;
+    double totalUnloadTime;
+    double totalTravelTime;
+    double totalIdleTime;
+    double totalStationOccupiedTime;
+    uint64_t tripsCompleted;
+    PercentileSummary queueWait;
+    PercentileSummary cycleTime;
+    PercentileSummary serviceTime;
+  };
+  static_assert(std::is_trivially_copyable_v<Record>);
+
+  std::string m_path;
+  int m_fd = -1;
+  ino_t m_inode = 0;
+  size_t m_indexedBytes = 0; // end of the last record indexed
+  std::unordered_map<CacheKey, Record, CacheKeyHash> m_index;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+  mutable std::mutex m_mutex;
+
+  static Record recordOf(const CacheKey &key, const SimResults &results) {
+    Record record{};
+    record.keyHi = key.hi;
+    record.keyLo = key.lo;
+    record.numTrucks = results.numTrucks;
+    record.numStations = results.numStations;
+    record.hasPercentiles = results.hasPercentiles ? 1 : 0;
+    record.durationSecs = results.durationSecs;
+    record.warmupSecs = results.warmupSecs;
+    record.totalMiningTime = results.totalMiningTime;
+    record.totalUnloadTime = results.totalUnloadTime;
+    record.totalTravelTime = results.totalTravelTime;
+    record.totalIdleTime = results.totalIdleTime;
+    record.totalStationOccupiedTime = results.totalStationOccupiedTime;
+    record.tripsCompleted = results.tripsCompleted;
+    record.queueWait = results.queueWait;
+    record.cycleTime = results.cycleTime;
+    record.serviceTime = results.serviceTime;
+    return record;
+  }
+
+  static SimResults resultsOf(const Record &record) {
+    SimResults results;
+    results.numTrucks = record.numTrucks;
+    results.numStations = record.numStations;
+    results.hasPercentiles = record.hasPercentiles != 0;
+    results.durationSecs = record.durationSecs;
+    results.warmupSecs = record.warmupSecs;
+    results.totalMiningTime = record.totalMiningTime;
+    results.totalUnloadTime = record.totalUnloadTime;
+    results.totalTravelTime = record.totalTravelTime;
+    results.totalIdleTime = record.totalIdleTime;
+    results.totalStationOccupiedTime = record.totalStationOccupiedTime;
+    results.tripsCompleted = record.tripsCompleted;
+    results.queueWait = record.queueWait;
+    results.cycleTime = record.cycleTime;
+    results.serviceTime = record.serviceTime;
+    return results;
+  }
+
+  // Keeps the most complete record of a key, the latest among equals
+  void index(const Record &record) {
+    CacheKey key{record.keyHi, record.keyLo};
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      m_index.emplace(key, record);
+    } else if (record.hasPercentiles || !it->second.hasPercentiles) {
+      it->second = record;
+    }
+  }
+
+  // Writes a header and records to a temporary file and renames it over
+  // the cache
+  void replace(const std::vector<Record> &records) {
+    std::string tmpPath = m_path + ".tmp." + std::to_string(getpid());
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot write result cache " + tmpPath);
+    }
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(Record);
+    bool ok = writeAll(fd, &header, sizeof(header)) &&
+              writeAll(fd, records.data(), records.size() * sizeof(Record)) &&
+              fsync(fd) == 0;
+    close(fd);
+    if (!ok || std::rename(tmpPath.c_str(), m_path.c_str()) != 0) {
+      unlink(tmpPath.c_str());
+      throw std::runtime_error("Cannot replace result cache " + m_path);
+    }
+  }
+
+  static bool writeAll(int fd, const void *data, size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+      ssize_t written = write(fd, bytes, size);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        return false;
+      }
+      bytes += written;
+      size -= static_cast<size_t>(written);
+    }
+    return true;
+  }
+
+  // (Re)opens the file, replacing it when missing or not a valid cache
+  void reopen() {
+    if (m_fd >= 0) {
+      close(m_fd);
+      m_fd = -1;
+    }
+    m_index.clear();
+    m_indexedBytes = 0;
+
+    int fd = open(m_path.c_str(), O_RDWR | O_APPEND);
+    if (fd < 0 && errno == ENOENT) {
+      replace({});
+      fd = open(m_path.c_str(), O_RDWR | O_APPEND);
+    }
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open result cache " + m_path);
+    }
+
+    Header header{};
+    struct stat info;
+    bool valid = fstat(fd, &info) == 0 &&
+                 pread(fd, &header, sizeof(header), 0) ==
+                     static_cast<ssize_t>(sizeof(header)) &&
+                 std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header.version == VERSION &&
+                 header.recordSize == sizeof(Record);
+    if (!valid) {
+      // Unknown format or another layout: start over
+      close(fd);
+      replace({});
+      fd = open(m_path.c_str(), O_RDWR | O_APPEND);
+      if (fd < 0 || fstat(fd, &info) != 0) {
+        throw std::runtime_error("Cannot open result cache " + m_path);
+      }
+    }
+    m_fd = fd;
+    m_inode = info.st_ino;
+    m_indexedBytes = sizeof(Header);
+    indexTail(static_cast<size_t>(info.st_size));
+
+    // A torn record (e.g. a crash mid-write) would misalign every later
+    // append, so the file is rewritten without it
+    if ((info.st_size - sizeof(Header)) % sizeof(Record) != 0) {
+      compactLocked();
+    }
+  }
+
+  // Indexes the complete records between the indexed end and a file size
+  void indexTail(size_t fileSize) {
+    size_t end = sizeof(Header) +
+                 (fileSize - sizeof(Header)) / sizeof(Record) * sizeof(Record);
+    if (end <= m_indexedBytes) {
+      return;
+    }
+    void *data = mmap(nullptr, end, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error("Cannot map result cache " + m_path);
+    }
+    const char *bytes = static_cast<const char *>(data);
+    for (size_t offset = m_indexedBytes; offset < end; offset += sizeof(Record)) {
+      Record record;
+      std::memcpy(&record, bytes + offset, sizeof(Record));
+      index(record);
+    }
+    munmap(data, end);
+    m_indexedBytes = end;
+  }
+
+  // Picks up records appended (or a file replaced) by other processes
+  void refresh() {
+    struct stat info;
+    if (stat(m_path.c_str(), &info) != 0 || info.st_ino != m_inode) {
+      reopen();
+      return;
+    }
+    if (static_cast<size_t>(info.st_size) > m_indexedBytes) {
+      indexTail(static_cast<size_t>(info.st_size));
+    }
+  }
+
+  void compactLocked() {
+    std::vector<Record> records;
+    records.reserve(m_index.size());
+    for (const auto &entry : m_index) {
+      records.push_back(entry.second);
+    }
+    replace(records);
+    reopen();
+  }
+
+public:
+  // Constructor
+  // \param path The cache file, created when missing.
+  explicit ResultCache(const std::string &path) : m_path(path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reopen();
+  }
+
+  ~ResultCache() {
+    if (m_fd >= 0) {
+      close(m_fd);
+    }
+  }
+
+  ResultCache(const ResultCache &) = delete;
+  ResultCache &operator=(const ResultCache &) = delete;
+
+  /// \brief Retrieves the key of a configuration, or nothing when its
+  /// results are not reproducible (unseeded or replaying a trace)
+  static std::optional<CacheKey> keyOf(const SimConfig &config) {
+    if (!config.seed || config.trace) {
+      return std::nullopt;
+    }
+    const uint64_t fields[] = {
+        ENGINE_VERSION,
+        config.numTrucks,
+        config.numStations,
+        *config.seed,
+        config.antithetic ? 1u : 0u,
+        std::bit_cast<uint64_t>(config.horizonSecs),
+        std::bit_cast<uint64_t>(config.warmupSecs),
+        config.autoWarmup ? 1u : 0u,
+        static_cast<uint64_t>(config.dispatch)};
+    CacheKey key{0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL};
+    for (uint64_t field : fields) {
+      key.hi = RandomStream::mix(key.hi ^ field);
+      key.lo = RandomStream::mix(key.lo + field * 0x9e3779b97f4a7c15ULL);
+    }
+    return key;
+  }
+
+  /// \brief Looks up the results of a configuration
+  /// \param config The configuration.
+  /// \param needPercentiles Whether results without percentile summaries
+  /// count as a miss.
+  std::optional<SimResults> find(const SimConfig &config,
+                                 bool needPercentiles = false) {
+    std::optional<CacheKey> key = keyOf(config);
+    if (!key) {
+      return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto usable = [&]() {
+      auto it = m_index.find(*key);
+      return it != m_index.end() &&
+                     (!needPercentiles || it->second.hasPercentiles)
+                 ? &it->second
+                 : nullptr;
+    };
+    const Record *record = usable();
+    if (record == nullptr) {
+      refresh();
+      record = usable();
+    }
+    if (record == nullptr) {
+      m_misses++;
+      return std::nullopt;
+    }
+    m_hits++;
+    return resultsOf(*record);
+  }
+
+  /// \brief Appends the results of a configuration, unless they are not
+  /// reproducible or already stored at least as completely
+  void insert(const SimConfig &config, const SimResults &results) {
+    std::optional<CacheKey> key = keyOf(config);
+    if (!key) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Record record = recordOf(*key, results);
+    while (true) {
+      // Another process may have compacted the file since the last look; the
+      // descriptor would then append to the replaced file, lost to everyone
+      refresh();
+      auto it = m_index.find(*key);
+      if (it != m_index.end() &&
+          (it->second.hasPercentiles || !results.hasPercentiles)) {
+        return;
+      }
+      if (!writeAll(m_fd, &record, sizeof(record))) {
+        throw std::runtime_error("Cannot append to result cache " + m_path);
+      }
+      index(record);
+
+      // Appended before any replacement of the file: done. Otherwise the
+      // record is written again unless the compaction already copied it.
+      struct stat info;
+      if (stat(m_path.c_str(), &info) == 0 && info.st_ino == m_inode) {
+        return;
+      }
+    }
+  }
+
+  /// \brief Rewrites the file with one record per key
+  void compact() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    refresh();
+    compactLocked();
+  }
+
+  /// \brief Retrieves the number of distinct configurations stored
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.size();
+  }
+
+  /// \brief Retrieves the number of lookups answered from the cache
+  uint64_t getHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+
+  /// \brief Retrieves the number of lookups that missed
+  uint64_t getMisses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+  }
+};
@@ -0,0 +1,510 @@
+#pragma once
+// Long-lived simulation server on a Unix domain socket
+#include "CApi.hpp"
+#include "ResultCache.hpp"
+#include "ThreadPool.hpp"
+#include "TruckSim.hpp"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/// \brief Frame types of the server protocol
+enum class ServerFrame : uint8_t {
+  // Client to server
+  RUN = 1,    // uint64 id, uint32 count, count x minesim_config
+  CANCEL = 2, // uint64 id
+  // Server to client
+  RESULT = 0x81, // uint64 id, uint32 index, minesim_result
+  DONE = 0x82    // uint64 id, int32 status
+};
+
+/// \brief Settings of the simulation server
+struct ServerOptions {
+  std::string socketPath;
+  uint32_t numWorkers = 0; // 0 means use hardware_concurrency
+  // Configurations queued or running across all clients; a request that
+  // would exceed it is rejected with MINESIM_ERR_BUSY. 0 means 64 per worker
+  uint32_t maxInFlight = 0;
+  // Bytes of frames queued for a client that does not read them; past it the
+  // client is disconnected and its requests cancelled. 0 means 16 MiB
+  size_t maxBacklog = 0;
+  // Results of earlier runs consulted before simulating (optional)
+  ResultCache *cache = nullptr;
+  // Raised (e.g. by a signal handler) to make run() return
+  const std::atomic<bool> *stop = nullptr;
+};
+
+/// \brief Serves simulation requests from local clients on a persistent
+/// worker pool, so a request costs only its simulation time.
+///
+/// Every frame is a uint32 length of what follows, a uint8 ServerFrame type
+/// and its payload, in native byte order; configurations and results are
+/// the plain structs of minesim.h. The configurations of a RUN request are
+/// simulated concurrently and each RESULT is sent as soon as it is done, in
+/// completion order, followed by one DONE carrying MINESIM_OK or the first
+/// failing status. CANCEL skips the configurations of a request that have
+/// not started and stops the running ones at their next statistics
+/// interval; they report MINESIM_ERR_CANCELLED. A client disconnecting
+/// cancels its requests.
+///
+/// Workers only queue their frames; a writer thread per client drains the
+/// queue over a non-blocking socket, so a client that stops reading never
+/// stalls the pool. It is dropped once its backlog exceeds the limit.
+class SimServer {
+  static constexpr uint32_t MAX_FRAME = 64u << 20;
+  static constexpr int POLL_MS = 100;
+  static constexpr size_t DEFAULT_BACKLOG = 16u << 20;
+
+  struct Request {
+    uint64_t id;
+    std::vector<minesim_config> configs;
+    std::atomic<bool> cancelled{false};
+    std::atomic<size_t> remaining{0};
+    std::atomic<int32_t> status{MINESIM_OK};
+  };
+
+  struct Connection {
+    int fd;
+    size_t maxBacklog;
+    std::atomic<bool> closed{false};   // the client went away
+    std::atomic<bool> dropped{false};  // the server gave up on the client
+    std::atomic<bool> draining{false}; // the writer sends what it can, then exits
+    std::mutex writeMutex;
+    std::condition_variable writeReady;
+    std::deque<std::vector<char>> outbound;
+    size_t outboundBytes = 0;
+    std::mutex requestsMutex;
+    std::unordered_map<uint64_t, std::shared_ptr<Request>> requests;
+
+    Connection(int socket, size_t backlog) : fd(socket), maxBacklog(backlog) {}
+    ~Connection() { close(fd); }
+
+    // Queues one frame for the writer; a client that went away just misses
+    // it, one that is too far behind is dropped
+    void send(ServerFrame type, const std::vector<char> &payload) {
+      uint32_t length = static_cast<uint32_t>(payload.size() + 1);
+      std::vector<char> frame(sizeof(length) + length);
+      std::memcpy(frame.data(), &length, sizeof(length));
+      frame[sizeof(length)] = static_cast<char>(type);
+      std::memcpy(frame.data() + sizeof(length) + 1, payload.data(),
+                  payload.size());
+
+      std::lock_guard<std::mutex> lock(writeMutex);
+      if (dropped || draining) {
+        return;
+      }
+      if (outboundBytes + frame.size() > maxBacklog) {
+        drop();
+        return;
+      }
+      outboundBytes += frame.size();
+      outbound.push_back(std::move(frame));
+      writeReady.notify_one();
+    }
+
+    // Disconnects the client: its reader and writer return, and the reader
+    // cancels its requests. Called with writeMutex held
+    void drop() {
+      if (dropped.exchange(true)) {
+        return;
+      }
+      shutdown(fd, SHUT_RDWR);
+      writeReady.notify_one();
+    }
+
+    void cancelAll() {
+      std::lock_guard<std::mutex> lock(requestsMutex);
+      for (auto &entry : requests) {
+        entry.second->cancelled = true;
+      }
+    }
+  };
+
+  // A connected client, read and written by its own threads
+  struct Client {
+    std::shared_ptr<Connection> connection;
+    std::thread reader;
+    std::thread writer;
+  };
+
+  ServerOptions m_options;
+  uint32_t m_maxInFlight;
+  size_t m_maxBacklog;
+  int m_listenFd = -1;
+  std::atomic<bool> m_stopping{false};
+  std::atomic<uint32_t> m_inFlight{0};
+  std::atomic<uint64_t> m_served{0};
+  std::vector<Client> m_clients;
+  // Declared last so queued tasks finish before anything they use is gone
+  ThreadPool m_pool;
+
+  template <typename T> static void put(std::vector<char> &out, const T &value) {
+    const char *bytes = reinterpret_cast<const char *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <typename T> static T get(const std::vector<char> &in, size_t offset) {
+    T value;
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    return value;
+  }
+
+  static bool readAll(int fd, void *data, size_t size) {
+    char *bytes = static_cast<char *>(data);
+    while (size > 0) {
+      ssize_t n = read(fd, bytes, size);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      bytes += n;
+      size -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  // Sends one frame without blocking the socket, waiting for room in its
+  // buffer unless the client is dropped or draining
+  static bool sendAll(Connection &connection, const std::vector<char> &frame) {
+    size_t sent = 0;
+    while (sent < frame.size()) {
+      ssize_t n = ::send(connection.fd, frame.data() + sent, frame.size() - sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (n > 0) {
+        sent += static_cast<size_t>(n);
+        continue;
+      }
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) ||
+          connection.dropped || connection.draining) {
+        return false;
+      }
+      pollfd writable{connection.fd, POLLOUT, 0};
+      poll(&writable, 1, POLL_MS);
+    }
+    return true;
+  }
+
+  // Drains the outbound queue of a client until it is dropped or, once it
+  // went away, nothing more can be sent
+  static void writeFrames(std::shared_ptr<Connection> connection) {
+    std::unique_lock<std::mutex> lock(connection->writeMutex);
+    while (true) {
+      connection->writeReady.wait(lock, [&connection]() {
+        return !connection->outbound.empty() || connection->dropped ||
+               connection->draining;
+      });
+      if (connection->dropped || connection->outbound.empty()) {
+        return;
+      }
+      std::vector<char> frame = std::move(connection->outbound.front());
+      connection->outbound.pop_front();
+      lock.unlock();
+      bool sent = sendAll(*connection, frame);
+      lock.lock();
+      connection->outboundBytes -= frame.size();
+      if (!sent) {
+        connection->drop();
+        return;
+      }
+    }
+  }
+
+  static void sendDone(Connection &connection, uint64_t id, int32_t status) {
+    std::vector<char> payload;
+    put(payload, id);
+    put(payload, status);
+    connection.send(ServerFrame::DONE, payload);
+  }
+
+  bool stopRequested() const {
+    return m_stopping || (m_options.stop && m_options.stop->load());
+  }
+
+  // Simulates one configuration of a request and streams its result
+  void runConfig(const std::shared_ptr<Connection> &connection,
+                 const std::shared_ptr<Request> &request, uint32_t index) {
+    const minesim_config &config = request->configs[index];
+    minesim_result result{};
+    result.num_trucks = config.num_trucks;
+    result.num_stations = config.num_stations;
+    result.status = request->cancelled ? MINESIM_ERR_CANCELLED
+                                       : validateConfig(config);
+    if (result.status == MINESIM_OK) {
+      SimConfig simConfig = toSimConfig(config);
+      simConfig.cancel = &request->cancelled;
+      try {
+        ResultCache *cache = m_options.cache;
+        std::optional<SimResults> cached =
+            cache ? cache->find(simConfig, true) : std::nullopt;
+        SimResults sim = cached ? *cached : TruckSim(simConfig).run();
+        if (cache && !cached) {
+          cache->insert(simConfig, sim);
+        }
+        fillResult(sim, result);
+      } catch (const SimulationCancelled &) {
+        result.status = MINESIM_ERR_CANCELLED;
+      } catch (...) {
+        result.status = MINESIM_ERR_INTERNAL;
+      }
+    }
+
+    std::vector<char> payload;
+    put(payload, request->id);
+    put(payload, index);
+    put(payload, result);
+    connection->send(ServerFrame::RESULT, payload);
+
+    if (result.status != MINESIM_OK) {
+      int32_t expected = MINESIM_OK;
+      request->status.compare_exchange_strong(expected, result.status);
+    }
+    m_inFlight--;
+    m_served++;
+    if (--request->remaining == 0) {
+      {
+        std::lock_guard<std::mutex> lock(connection->requestsMutex);
+        connection->requests.erase(request->id);
+      }
+      sendDone(*connection, request->id, request->status);
+    }
+  }
+
+  void handleRun(const std::shared_ptr<Connection> &connection,
+                 const std::vector<char> &payload) {
+    size_t header = sizeof(uint64_t) + sizeof(uint32_t);
+    if (payload.size() < header) {
+      sendDone(*connection, 0, MINESIM_ERR_INVALID_ARGUMENT);
+      return;
+    }
+    auto id = get<uint64_t>(payload, 0);
+    auto count = get<uint32_t>(payload, sizeof(uint64_t));
+    if (payload.size() != header + size_t(count) * sizeof(minesim_config)) {
+      sendDone(*connection, id, MINESIM_ERR_INVALID_ARGUMENT);
+      return;
+    }
+    if (count == 0) {
+      sendDone(*connection, id, MINESIM_OK);
+      return;
+    }
+
+    // Admission control: all of the request or none of it
+    uint32_t inFlight = m_inFlight.load();
+    do {
+      if (inFlight + uint64_t(count) > m_maxInFlight) {
+        sendDone(*connection, id, MINESIM_ERR_BUSY);
+        return;
+      }
+    } while (!m_inFlight.compare_exchange_weak(inFlight, inFlight + count));
+
+    auto request = std::make_shared<Request>();
+    request->id = id;
+    request->configs.resize(count);
+    std::memcpy(request->configs.data(), payload.data() + header,
+                size_t(count) * sizeof(minesim_config));
+    request->remaining = count;
+    {
+      std::lock_guard<std::mutex> lock(connection->requestsMutex);
+      if (!connection->requests.emplace(id, request).second) {
+        m_inFlight -= count;
+        sendDone(*connection, id, MINESIM_ERR_INVALID_ARGUMENT);
+        return;
+      }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+      m_pool.enqueue([this, connection, request, i]() {
+        runConfig(connection, request, i);
+      });
+    }
+  }
+
+  void handleCancel(Connection &connection, const std::vector<char> &payload) {
+    if (payload.size() != sizeof(uint64_t)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(connection.requestsMutex);
+    auto it = connection.requests.find(get<uint64_t>(payload, 0));
+    if (it != connection.requests.end()) {
+      it->second->cancelled = true;
+    }
+  }
+
+  // Reads the frames of a client until it disconnects or breaks framing
+  void serve(std::shared_ptr<Connection> connection) {
+    while (true) {
+      uint32_t length = 0;
+      if (!readAll(connection->fd, &length, sizeof(length)) || length == 0 ||
+          length > MAX_FRAME) {
+        break;
+      }
+      uint8_t type = 0;
+      std::vector<char> payload(length - 1);
+      if (!readAll(connection->fd, &type, 1) ||
+          !readAll(connection->fd, payload.data(), payload.size())) {
+        break;
+      }
+      switch (static_cast<ServerFrame>(type)) {
+      case ServerFrame::RUN:
+        handleRun(connection, payload);
+        break;
+      case ServerFrame::CANCEL:
+        handleCancel(*connection, payload);
+        break;
+      default:
+        sendDone(*connection, 0, MINESIM_ERR_INVALID_ARGUMENT);
+        break;
+      }
+    }
+    connection->cancelAll();
+    connection->closed = true;
+  }
+
+  // Joins the threads of the clients that went away, once their writer has
+  // sent what the socket accepts without waiting
+  void pruneClients() {
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+      if (it->connection->closed) {
+        {
+          std::lock_guard<std::mutex> lock(it->connection->writeMutex);
+          it->connection->draining = true;
+          it->connection->writeReady.notify_one();
+        }
+        it->writer.join();
+        it->reader.join();
+        it = m_clients.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+public:
+  // Constructor: binds and listens on the socket (replacing a stale one)
+  // and starts the worker pool
+  // \param options The server settings.
+  explicit SimServer(const ServerOptions &options)
+      : m_options(options),
+        m_pool(options.numWorkers > 0 ? options.numWorkers
+                                      : std::thread::hardware_concurrency()) {
+    m_maxInFlight = options.maxInFlight > 0
+                        ? options.maxInFlight
+                        : 64 * static_cast<uint32_t>(m_pool.size());
+    m_maxBacklog = options.maxBacklog > 0 ? options.maxBacklog : DEFAULT_BACKLOG;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() ||
+        options.socketPath.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("Invalid server socket path " + options.socketPath);
+    }
+    std::strncpy(address.sun_path, options.socketPath.c_str(),
+                 sizeof(address.sun_path) - 1);
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+      throw std::runtime_error("Cannot create server socket");
+    }
+    // Only a socket nobody listens on any more is replaced
+    struct stat info;
+    if (lstat(options.socketPath.c_str(), &info) == 0) {
+      if (!S_ISSOCK(info.st_mode)) {
+        close(m_listenFd);
+        throw std::runtime_error("Cannot listen on " + options.socketPath +
+                                 ": not a socket");
+      }
+      int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+      bool stale = probe >= 0 &&
+                   connect(probe, reinterpret_cast<sockaddr *>(&address),
+                           sizeof(address)) != 0 &&
+                   errno == ECONNREFUSED;
+      if (probe >= 0) {
+        close(probe);
+      }
+      if (!stale) {
+        close(m_listenFd);
+        throw std::runtime_error("Cannot listen on " + options.socketPath +
+                                 ": address in use");
+      }
+      unlink(options.socketPath.c_str());
+    }
+    if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+        listen(m_listenFd, SOMAXCONN) != 0) {
+      close(m_listenFd);
+      throw std::runtime_error("Cannot listen on " + options.socketPath + ": " +
+                               std::strerror(errno));
+    }
+  }
+
+  ~SimServer() {
+    stop();
+    close(m_listenFd);
+    unlink(m_options.socketPath.c_str());
+  }
+
+  SimServer(const SimServer &) = delete;
+  SimServer &operator=(const SimServer &) = delete;
+
+  /// \brief Retrieves the number of worker threads
+  size_t getNumWorkers() const { return m_pool.size(); }
+
+  /// \brief Retrieves the admission limit of configurations in flight
+  uint32_t getMaxInFlight() const { return m_maxInFlight; }
+
+  /// \brief Retrieves the number of configurations answered so far
+  uint64_t getServed() const { return m_served; }
+
+  /// \brief Makes run() return; safe to call from any thread
+  void stop() { m_stopping = true; }
+
+  /// \brief Accepts clients until stop() or the stop flag of the options.
+  /// On return every client is disconnected and its requests cancelled.
+  void run() {
+    while (!stopRequested()) {
+      pruneClients();
+      pollfd listener{m_listenFd, POLLIN, 0};
+      if (poll(&listener, 1, POLL_MS) <= 0) {
+        continue;
+      }
+      int fd = accept(m_listenFd, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      auto connection = std::make_shared<Connection>(fd, m_maxBacklog);
+      m_clients.push_back({connection,
+                           std::thread(&SimServer::serve, this, connection),
+                           std::thread(&SimServer::writeFrames, connection)});
+    }
+
+    for (Client &client : m_clients) {
+      client.connection->cancelAll();
+      std::lock_guard<std::mutex> lock(client.connection->writeMutex);
+      client.connection->drop();
+    }
+    for (Client &client : m_clients) {
+      client.reader.join();
+      client.writer.join();
+    }
+    m_clients.clear();
+  }
+};
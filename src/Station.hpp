@@ -1,4 +1,5 @@
 #pragma once
+#include "Histogram.hpp"
 #include "Truck.hpp"
 #include <unordered_map>
 
@@ -6,8 +7,9 @@ class Station {
 private:
   int m_id;
   float m_dt;
-  float m_timeOccupied = 0.0f;
-  float m_timeRemaining = 0.0f;
+  double m_timeOccupied = 0.0;
+  float m_timeRemaining = 0.0f; // Unload ticks left of the truck in service
+  float m_visitTime = 0.0f; // Time the current truck has occupied the station
   Truck *m_truckInStation = nullptr;
 
   std::unordered_map<uint32_t, float> m_truckTimes;
@@ -22,16 +24,27 @@ public:
   int getId() const { return m_id; }
 
   /// \brief Retrieves the amount of time the station has been occupied.
-  float getTimeOccupied() const { return m_timeOccupied; }
+  double getTimeOccupied() const { return m_timeOccupied; }
 
   /// \brief Returns the pointer to the truck currently in the station
   Truck *getTruckInStation() const { return m_truckInStation; }
 
+  /// \brief Retrieves the unload time left of the truck in service
+  float getServiceTimeLeft() const {
+    return m_truckInStation != nullptr ? m_timeRemaining * m_dt : 0.0f;
+  }
+
   /// \brief Retrieves all the times a specific truck has been in the station
   std::unordered_map<uint32_t, float> getTruckTimes() const {
     return m_truckTimes;
   }
 
+  /// \brief Clears the accumulated statistics, keeping the truck in service
+  void resetStats() {
+    m_timeOccupied = 0.0;
+    m_truckTimes.clear();
+  }
+
   /// \brief Sets the pointer to the truck currently in the station
   void setTruckInStation(Truck *truck) {
     m_truckInStation = truck;
@@ -40,19 +53,27 @@ public:
   }
 
   /// \brief Updates the state of the station per timestep
-  void update() {
+  /// \param serviceTimes Optional histogram of per-visit service intervals
+  void update(Histogram *serviceTimes = nullptr) {
     if (m_truckInStation != nullptr) {
       // Update how long a specific truck has been in a station
       // and total time station has been occupied
 
       // If the truck is done unloading, remove it from the station and update
-      // its state
-      if (m_truckInStation->getUnloadTimeLeft() <= 0) {
+      // its state. The station counts the unload down itself, so trucks need
+      // not be touched on every tick
+      if (m_timeRemaining <= 0) {
         m_truckInStation->setHasStation(false);
         m_truckInStation = nullptr;
+        if (serviceTimes != nullptr) {
+          serviceTimes->recordSeconds(m_visitTime);
+        }
+        m_visitTime = 0.0f;
       } else {
         m_truckTimes[m_truckInStation->getId()] += m_dt;
         m_timeOccupied += m_dt;
+        m_visitTime += m_dt;
+        m_timeRemaining -= 1.0f;
       }
     }
   }
@@ -1,13 +1,64 @@
 #pragma once
 
+#include "Histogram.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <vector>
 
+/**
+ * Counters of one worker thread, read through ThreadPool::telemetry().
+ * Times are in nanoseconds.
+ */
+struct WorkerTelemetry {
+    uint64_t tasksRun = 0;
+    uint64_t busyNs = 0;     // running tasks
+    uint64_t idleNs = 0;     // waiting for a task
+    uint64_t lockWaitNs = 0; // acquiring the queue mutex
+    Histogram startLatencyNs; // enqueue to start of each task
+};
+
+/**
+ * Snapshot of the telemetry of a thread pool.
+ */
+struct PoolTelemetry {
+    std::vector<WorkerTelemetry> workers;
+    uint64_t tasksEnqueued = 0;
+    uint64_t maxQueueDepth = 0;
+    uint64_t enqueueLockWaitNs = 0; // acquiring the queue mutex in enqueue()
+
+    /**
+     * Returns the counters of all workers combined.
+     */
+    WorkerTelemetry total() const {
+        WorkerTelemetry sum;
+        for (const WorkerTelemetry &worker : workers) {
+            sum.tasksRun += worker.tasksRun;
+            sum.busyNs += worker.busyNs;
+            sum.idleNs += worker.idleNs;
+            sum.lockWaitNs += worker.lockWaitNs;
+            sum.startLatencyNs.merge(worker.startLatencyNs);
+        }
+        return sum;
+    }
+
+    /**
+     * Returns the fraction of worker time spent running tasks.
+     */
+    double utilization() const {
+        WorkerTelemetry sum = total();
+        uint64_t elapsed = sum.busyNs + sum.idleNs + sum.lockWaitNs;
+        return elapsed > 0 ? static_cast<double>(sum.busyNs) / elapsed : 0.0;
+    }
+};
+
 /**
  * A thread pool for parallelizing truck operations in the lunar mining simulation.
  * Uses a fixed number of worker threads to process tasks from a shared queue.
@@ -18,15 +69,26 @@ public:
      * Constructor initializes the thread pool with the specified number of worker threads.
      * 
      * @param numThreads Number of worker threads to create (defaults to hardware concurrency)
+     * @param telemetry Whether the workers record the counters read by telemetry()
      */
-    ThreadPool(size_t numThreads = std::thread::hardware_concurrency()) 
-        : m_stop(false) {
+    ThreadPool(size_t numThreads = std::thread::hardware_concurrency(),
+               bool telemetry = false) 
+        : m_stop(false), m_telemetry(telemetry) {
         // Ensure at least one thread
         numThreads = numThreads > 0 ? numThreads : 1;
+        if (m_telemetry) {
+            m_counters = std::make_unique<WorkerCounters[]>(numThreads);
+        }
         
         // Create the worker threads
         for (size_t i = 0; i < numThreads; ++i) {
-            m_workers.emplace_back([this] {
+            m_workers.emplace_back([this, i] {
+                t_ownerPool = this;
+                t_workerIndex = i;
+                if (m_telemetry) {
+                    runWithTelemetry(m_counters[i]);
+                    return;
+                }
                 while (true) {
                     std::function<void()> task;
                     {
@@ -42,7 +104,7 @@ public:
                         }
                         
                         // Get the next task
-                        task = std::move(m_tasks.front());
+                        task = std::move(m_tasks.front().function);
                         m_tasks.pop();
                     }
                     
@@ -96,7 +158,9 @@ public:
         // Get the future result before pushing the task
         std::future<return_type> res = task->get_future();
         {
+            uint64_t requested = m_telemetry ? nowNs() : 0;
             std::unique_lock<std::mutex> lock(m_queueMutex);
+            uint64_t acquired = m_telemetry ? nowNs() : 0;
             
             // Don't allow enqueueing after stopping the pool
             if (m_stop) {
@@ -104,7 +168,12 @@ public:
             }
             
             // Wrap the packaged task in a void function for the queue
-            m_tasks.emplace([task]() { (*task)(); });
+            m_tasks.push({[task]() { (*task)(); }, acquired});
+            if (m_telemetry) {
+                m_enqueueLockWaitNs += acquired - requested;
+                m_tasksEnqueued++;
+                m_maxQueueDepth = std::max<uint64_t>(m_maxQueueDepth, m_tasks.size());
+            }
         }
         
         // Notify one worker thread that a task is available
@@ -119,16 +188,145 @@ public:
     size_t size() const {
         return m_workers.size();
     }
+    
+    /**
+     * Returns the index of the calling thread within this pool, or size()
+     * when the caller is not one of this pool's workers. Lets tasks pick a
+     * per-worker slot without synchronization.
+     */
+    size_t currentWorkerIndex() const {
+        return t_ownerPool == this ? t_workerIndex : m_workers.size();
+    }
+
+    /**
+     * Returns whether the pool records telemetry.
+     */
+    bool hasTelemetry() const {
+        return m_telemetry;
+    }
+
+    /**
+     * Returns a snapshot of the telemetry counters (empty when the pool was
+     * created without telemetry). Safe to call while tasks are running; a
+     * task in progress is counted once it finishes, a worker waiting for a
+     * task is counted as idle up to now.
+     */
+    PoolTelemetry telemetry() const {
+        PoolTelemetry snapshot;
+        if (!m_telemetry) {
+            return snapshot;
+        }
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        uint64_t now = nowNs();
+        snapshot.tasksEnqueued = m_tasksEnqueued;
+        snapshot.maxQueueDepth = m_maxQueueDepth;
+        snapshot.enqueueLockWaitNs = m_enqueueLockWaitNs;
+        for (size_t i = 0; i < m_workers.size(); ++i) {
+            const WorkerCounters &counters = m_counters[i];
+            WorkerTelemetry worker;
+            worker.tasksRun = counters.tasksRun.load(std::memory_order_relaxed);
+            worker.busyNs = counters.busyNs.load(std::memory_order_relaxed);
+            worker.idleNs = counters.idleNs.load(std::memory_order_relaxed);
+            // Workers waiting on the condition do not hold the mutex, so
+            // waitingSince is stable while we do
+            uint64_t waitingSince = counters.waitingSince;
+            if (waitingSince != 0) {
+                worker.idleNs += now - std::min(now, waitingSince);
+            }
+            worker.lockWaitNs = counters.lockWaitNs.load(std::memory_order_relaxed);
+            worker.startLatencyNs = counters.startLatencyNs;
+            snapshot.workers.push_back(std::move(worker));
+        }
+        return snapshot;
+    }
 
 private:
+    struct Task {
+        std::function<void()> function;
+        uint64_t enqueuedNs; // set only with telemetry
+    };
+
+    /**
+     * Counters written by a single worker. Each worker owns a cache line
+     * aligned block so workers never share a line. The scalars are atomics
+     * so snapshots may read them at any time; the latency histogram and the
+     * wait start are only written while holding the queue mutex.
+     */
+    struct alignas(64) WorkerCounters {
+        std::atomic<uint64_t> tasksRun{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> idleNs{0};
+        std::atomic<uint64_t> lockWaitNs{0};
+        uint64_t waitingSince = 0; // start of the current wait, 0 if none
+        Histogram startLatencyNs;
+    };
+
+    static uint64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Single-writer increment, cheaper than an atomic read-modify-write
+    static void add(std::atomic<uint64_t> &counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    /**
+     * Worker loop that times lock acquisition, waiting and running.
+     */
+    void runWithTelemetry(WorkerCounters &counters) {
+        while (true) {
+            std::function<void()> task;
+            uint64_t started;
+            {
+                uint64_t requested = nowNs();
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                uint64_t acquired = nowNs();
+                counters.waitingSince = acquired;
+                m_condition.wait(lock, [this] {
+                    return m_stop || !m_tasks.empty();
+                });
+                started = nowNs();
+                counters.waitingSince = 0;
+                add(counters.lockWaitNs, acquired - requested);
+                add(counters.idleNs, started - acquired);
+
+                if (m_stop && m_tasks.empty()) {
+                    return;
+                }
+
+                Task &next = m_tasks.front();
+                counters.startLatencyNs.record(started - std::min(started, next.enqueuedNs));
+                task = std::move(next.function);
+                m_tasks.pop();
+            }
+
+            task();
+            add(counters.busyNs, nowNs() - started);
+            add(counters.tasksRun, 1);
+        }
+    }
+
     // Worker threads
     std::vector<std::thread> m_workers;
     
     // Task queue
-    std::queue<std::function<void()>> m_tasks;
+    std::queue<Task> m_tasks;
     
     // Synchronization
-    std::mutex m_queueMutex;
+    mutable std::mutex m_queueMutex;
     std::condition_variable m_condition;
     bool m_stop;
+
+    // Telemetry, guarded by m_queueMutex apart from the worker scalars
+    bool m_telemetry;
+    std::unique_ptr<WorkerCounters[]> m_counters;
+    uint64_t m_tasksEnqueued = 0;
+    uint64_t m_maxQueueDepth = 0;
+    uint64_t m_enqueueLockWaitNs = 0;
+    
+    // Pool and index of the worker running on the current thread
+    static inline thread_local const ThreadPool *t_ownerPool = nullptr;
+    static inline thread_local size_t t_workerIndex = 0;
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+// Hierarchical timing wheel of integer tick deadlines
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// \brief Schedules entries 0..capacity-1 at absolute tick deadlines and
+/// yields, tick by tick, only the entries whose deadline is that tick.
+///
+/// Level l has SLOTS slots of SLOTS^l ticks each and holds the entries due in
+/// [SLOTS^l, SLOTS^(l+1)) ticks. When the clock reaches the start of a slot of
+/// an upper level, its entries cascade down by their remaining delay, so an
+/// entry is touched at most once per level. Lists are intrusive (one next
+/// index per entry), so scheduling never allocates.
+class TimingWheel {
+public:
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+private:
+  static constexpr uint32_t SLOT_BITS = 6;
+  static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+  static constexpr uint32_t LEVELS = 4;
+  // Delays beyond the range are parked in the last slot reachable and
+  // re-scheduled by their true deadline when it cascades
+  static constexpr uint64_t RANGE = uint64_t(1) << (SLOT_BITS * LEVELS);
+
+  uint64_t m_now = 0;
+  size_t m_size = 0;
+  std::array<std::array<uint32_t, SLOTS>, LEVELS> m_heads;
+  std::vector<uint32_t> m_next;
+  std::vector<uint64_t> m_deadlines;
+
+  static uint32_t slotOf(uint64_t tick, uint32_t level) {
+    return static_cast<uint32_t>(tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+  }
+
+  void insert(uint32_t id) {
+    uint64_t deadline = m_deadlines[id];
+    uint64_t delay = deadline - m_now;
+    uint64_t slotTick = delay < RANGE ? deadline : m_now + RANGE - 1;
+    delay = slotTick - m_now;
+
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delay >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+      level++;
+    }
+    uint32_t &head = m_heads[level][slotOf(slotTick, level)];
+    m_next[id] = head;
+    head = id;
+  }
+
+  // Re-inserts the entries of a slot that starts at the current tick
+  void cascade(uint32_t level) {
+    uint32_t &head = m_heads[level][slotOf(m_now, level)];
+    uint32_t id = head;
+    head = NONE;
+    while (id != NONE) {
+      uint32_t next = m_next[id];
+      insert(id);
+      id = next;
+    }
+  }
+
+public:
+  // Constructor
+  // \param capacity Number of entries (ids 0..capacity-1) that can be scheduled.
+  // \param start Tick of the clock.
+  explicit TimingWheel(size_t capacity, uint64_t start = 0)
+      : m_now(start), m_next(capacity, NONE), m_deadlines(capacity, 0) {
+    for (auto &level : m_heads) {
+      level.fill(NONE);
+    }
+  }
+
+  /// \brief Retrieves the current tick of the clock
+  uint64_t now() const { return m_now; }
+
+  /// \brief Retrieves the number of scheduled entries
+  size_t size() const { return m_size; }
+
+  /// \brief Schedules an entry that is not already scheduled
+  /// \param id The entry.
+  /// \param deadline Tick at which the entry expires, after now(). An
+  /// earlier one expires on the next tick, since the wheel has already
+  /// yielded the current tick and a past slot would only be reached after a
+  /// full turn.
+  void schedule(uint32_t id, uint64_t deadline) {
+    m_deadlines[id] = std::max(deadline, m_now + 1);
+    insert(id);
+    m_size++;
+  }
+
+  /// \brief Advances the clock by one tick and calls onExpire(id) for every
+  /// entry due at the new tick. The callback may schedule entries.
+  template <typename OnExpire> void advance(OnExpire &&onExpire) {
+    m_now++;
+    // Upper levels first, so entries cascading through several levels in
+    // the same tick end up in their final slot
+    for (uint32_t level = LEVELS - 1; level > 0; --level) {
+      if ((m_now & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+        cascade(level);
+      }
+    }
+
+    uint32_t &head = m_heads[0][slotOf(m_now, 0)];
+    uint32_t id = head;
+    head = NONE;
+    while (id != NONE) {
+      uint32_t next = m_next[id];
+      m_next[id] = NONE;
+      m_size--;
+      onExpire(id);
+      id = next;
+    }
+  }
+};
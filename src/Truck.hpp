@@ -1,5 +1,9 @@
 #pragma once
-#include <random>
+#include "Histogram.hpp"
+#include "Random.hpp"
+#include <cmath>
+#include <cstdint>
+#include <span>
 
 // Enum to represent the simplified state of a mining truck
 enum class TruckState {
@@ -10,66 +14,193 @@ enum class TruckState {
   IDLE
 };
 
+/// \brief Time spent in each truck state, in seconds
+struct TruckTotals {
+  double mining = 0.0;
+  double unload = 0.0;
+  double travel = 0.0;
+  double idle = 0.0;
+
+  double sum() const { return mining + unload + travel + idle; }
+
+  TruckTotals &operator+=(const TruckTotals &other) {
+    mining += other.mining;
+    unload += other.unload;
+    travel += other.travel;
+    idle += other.idle;
+    return *this;
+  }
+};
+
 class Truck {
 
   int m_id;
   float m_dt;
   TruckState m_state;
 
-  float m_miningTimeLeft;
-  float m_miningTimeTotal = 0;
-  float m_unloadTimeLeft;
-  float m_unloadTimeTotal = 0;
-  float m_travelTimeLeft;
-  float m_travelTimeTotal = 0;
-  float m_idleTimeTotal = 0;
-  uint32_t m_tripsCompleted;
-
-  bool m_isUnloading;
-  bool m_isTravelingToSite;
-  bool m_isTravelingToStation;
-  bool m_isMining;
+  // Timed states end at an absolute tick deadline. Time in a state is
+  // accounted from entry and exit ticks: m_stateSince is the first tick not
+  // yet accounted, m_now the tick the truck was last advanced to. The window
+  // holds the time since the last flush, which moves it into m_flushedTotals
+  uint64_t m_now = 0;
+  uint64_t m_stateSince = 0;
+  uint64_t m_deadline = 0;
+  uint64_t m_miningTicks;    // duration of the current or next mining period
+  uint64_t m_cycleStart = 0; // tick at which the current trip started
+  TruckTotals m_windowTotals;
+  TruckTotals m_flushedTotals;
+  uint32_t m_tripsCompleted = 0;
+  double m_queueWait = 0; // Waiting time of the current station visit
+
+  // Mining durations are drawn from a per-truck stream so that runs sharing
+  // a seed see the same duration for every truck and cycle
+  RandomStream m_miningStream;
+  // Recorded durations replayed in place of the stream, when not empty
+  std::span<const float> m_trace;
+  size_t m_traceCursor = 0;
+
   bool m_hasStation;
   static constexpr float HRS_TO_SECS = 3600.0f;
   static constexpr float MINE_TIME_MAX = 5.0f;
   static constexpr float MINE_TIME_MIN = 1.0f;
 
+  uint64_t ticksOf(float seconds) const {
+    return static_cast<uint64_t>(std::ceil(seconds / m_dt));
+  }
+
+  // Accounts the time in the current state up to a tick
+  void account(uint64_t tick) {
+    double elapsed = (tick - m_stateSince) * static_cast<double>(m_dt);
+    switch (m_state) {
+    case TruckState::MINING:
+      m_windowTotals.mining += elapsed;
+      break;
+    case TruckState::TRAVELING_TO_STATION:
+    case TruckState::TRAVELING_TO_SITE:
+      m_windowTotals.travel += elapsed;
+      break;
+    case TruckState::UNLOADING:
+      m_windowTotals.unload += elapsed;
+      break;
+    case TruckState::IDLE:
+      m_windowTotals.idle += elapsed;
+      m_queueWait += elapsed;
+      break;
+    }
+    m_stateSince = tick;
+  }
+
+  // Closes the current state at a tick and enters a new one, which starts
+  // counting from the next tick
+  void transition(TruckState newState, uint64_t tick) {
+    m_now = tick;
+    account(tick);
+    m_state = newState;
+    switch (newState) {
+    case TruckState::MINING:
+      m_deadline = tick + m_miningTicks;
+      break;
+    case TruckState::TRAVELING_TO_STATION:
+    case TruckState::TRAVELING_TO_SITE:
+      m_deadline = tick + ticksOf(TRAVEL_TIME);
+      break;
+    case TruckState::UNLOADING:
+      m_deadline = tick + ticksOf(UNLOAD_TIME);
+      break;
+    case TruckState::IDLE:
+      break;
+    }
+  }
+
+  // Time in a state, including the part not yet accounted
+  double totalOf(double TruckTotals::*field, bool inState) const {
+    double open = inState ? (m_now - m_stateSince) * static_cast<double>(m_dt)
+                          : 0.0;
+    return m_flushedTotals.*field + m_windowTotals.*field + open;
+  }
+
 public:
   static constexpr float UNLOAD_TIME = 300.0f;
   static constexpr float TRAVEL_TIME = 1800.0f;
 
   Truck(int truckId, float dt)
+      : Truck(truckId, dt, RandomStream::randomSeed()) {}
+
+  // Constructor
+  // \param truckId The identifier of the truck.
+  // \param dt The time step of the simulation.
+  // \param seed Seed of the mining-duration stream (common random numbers).
+  // \param antithetic Whether the truck draws mirrored uniforms.
+  Truck(int truckId, float dt, uint64_t seed, bool antithetic = false)
       : m_id(truckId), m_dt(dt), m_state(TruckState::MINING),
-        m_isUnloading(false), m_isTravelingToSite(false),
-        m_isTravelingToStation(false), m_isMining(true), m_hasStation(false) {
+        m_miningStream(seed, static_cast<uint64_t>(truckId), antithetic),
+        m_hasStation(false) {
     // Initialize with random mining time (1-5 hours)
-    m_miningTimeLeft = (int)getRandomMiningTime() / m_dt;
+    m_miningTicks = ticksOf((int)nextMiningTime());
+    m_deadline = m_miningTicks;
+  }
+
+  // Constructor
+  // \param truckId The identifier of the truck.
+  // \param dt The time step of the simulation.
+  // \param trace Recorded mining durations (seconds) replayed cycle by cycle,
+  // wrapping around at the end. Must not be empty.
+  Truck(int truckId, float dt, std::span<const float> trace)
+      : m_id(truckId), m_dt(dt), m_state(TruckState::MINING),
+        m_miningStream(0, static_cast<uint64_t>(truckId)), m_trace(trace),
+        m_hasStation(false) {
+    m_miningTicks = ticksOf((int)nextMiningTime());
+    m_deadline = m_miningTicks;
   }
 
   int getId() const { return m_id; }
   /// \brief Retrieves the current state of the truck
   TruckState getState() const { return m_state; }
 
-  /// \brief Sets the state of the truck
-  void setState(TruckState newState) { m_state = newState; }
+  /// \brief Sets the state of the truck at its current tick
+  void setState(TruckState newState) { transition(newState, m_now); }
+
+  /// \brief Sets the state of the truck at a given tick (not before the
+  /// truck's current tick), e.g. when the simulation assigns it a station
+  void setState(TruckState newState, uint64_t tick) {
+    transition(newState, tick);
+  }
+
+  /// \brief Retrieves the tick at which the current timed state ends
+  uint64_t getDeadline() const { return m_deadline; }
 
   /// \brief Retrieves the amount of time left until the truck is done mining
-  float getMiningTimeLeft() const { return m_miningTimeLeft; }
+  float getMiningTimeLeft() const {
+    return m_state == TruckState::MINING ? m_deadline - m_now : m_miningTicks;
+  }
 
   /// \brief Retrieves the total amount of time the truck has spent mining
-  float getMiningTimeTotal() const { return m_miningTimeTotal; }
+  double getMiningTimeTotal() const {
+    return totalOf(&TruckTotals::mining, m_state == TruckState::MINING);
+  }
   
   /// \brief Retrieves the amount of time left until the truck is done unloading
-  float getUnloadTimeLeft() const { return m_unloadTimeLeft; }
+  float getUnloadTimeLeft() const {
+    return m_state == TruckState::UNLOADING ? m_deadline - m_now
+                                            : ticksOf(UNLOAD_TIME);
+  }
 
   /// \brief Retrieves the total amount of time the truck has spent unloading
-  float getUnloadTimeTotal() const { return m_unloadTimeTotal; }
+  double getUnloadTimeTotal() const {
+    return totalOf(&TruckTotals::unload, m_state == TruckState::UNLOADING);
+  }
 
   /// \brief Retrieves the total amount of time the truck has spent traveling
-  float getTravelTimeTotal() const { return m_travelTimeTotal; }
+  double getTravelTimeTotal() const {
+    return totalOf(&TruckTotals::travel,
+                   m_state == TruckState::TRAVELING_TO_STATION ||
+                       m_state == TruckState::TRAVELING_TO_SITE);
+  }
 
   /// \brief Retrieves the total amount of time the truck has spent waiting for a station
-  float getIdleTimeTotal() const { return m_idleTimeTotal; }
+  double getIdleTimeTotal() const {
+    return totalOf(&TruckTotals::idle, m_state == TruckState::IDLE);
+  }
 
   /// \brief Retrieves the total number of trips the truck has completed
   uint32_t getTripsCompleted() const { return m_tripsCompleted; }
@@ -80,64 +211,100 @@ public:
   /// \brief Sets the state of the truckif it has a station
   void setHasStation(bool newState) { m_hasStation = newState; }
 
-  /// \brief Generates a random mining time
-  float getRandomMiningTime() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> miningDist(MINE_TIME_MIN, MINE_TIME_MAX);
+  /// \brief Accounts the time up to a tick and moves it into the running
+  /// totals
+  /// \return The time spent in each state since the previous flush
+  TruckTotals flushStats(uint64_t tick) {
+    m_now = tick;
+    account(tick);
+    TruckTotals window = m_windowTotals;
+    m_flushedTotals += window;
+    m_windowTotals = TruckTotals();
+    return window;
+  }
+
+  /// \brief Accounts the time up to the truck's current tick and moves it
+  /// into the running totals
+  TruckTotals flushStats() { return flushStats(m_now); }
+
+  /// \brief Clears the accumulated statistics (e.g. at the end of warm-up),
+  /// keeping the state of the trip in progress
+  void resetStats(uint64_t tick) {
+    m_now = tick;
+    account(tick);
+    m_windowTotals = TruckTotals();
+    m_flushedTotals = TruckTotals();
+    m_tripsCompleted = 0;
+  }
+
+  /// \brief Clears the accumulated statistics at the truck's current tick
+  void resetStats() { resetStats(m_now); }
+
+  /// \brief Maps a uniform in [0, 1) to a mining time (1-5 hours), in seconds
+  static float miningTimeOf(double u) {
+    return static_cast<float>(
+        (MINE_TIME_MIN + u * (MINE_TIME_MAX - MINE_TIME_MIN)) * HRS_TO_SECS);
+  }
 
-    return (miningDist(gen) * HRS_TO_SECS);
+  /// \brief Generates the mining time of the next cycle from the truck's stream
+  float getRandomMiningTime() {
+    return miningTimeOf(m_miningStream.nextUniform());
   }
 
-  /// \brief Main function to call on each timestep for individual trucks
-  void update() {
+  /// \brief Retrieves the mining time of the next cycle: the next recorded
+  /// duration when replaying a trace, a draw from the stream otherwise
+  float nextMiningTime() {
+    if (m_trace.empty()) {
+      return getRandomMiningTime();
+    }
+    float duration = m_trace[m_traceCursor];
+    m_traceCursor = m_traceCursor + 1 < m_trace.size() ? m_traceCursor + 1 : 0;
+    return duration;
+  }
 
+  /// \brief Ends the current timed state at its deadline and enters the next
+  /// one. A truck arriving at the stations enters UNLOADING and waits there
+  /// for the simulation to route it.
+  /// \param tick The deadline of the current state.
+  /// \param histograms Optional per-trip histograms to record into
+  void expire(uint64_t tick, TripHistograms *histograms = nullptr) {
     switch (m_state) {
     case TruckState::MINING:
-      m_miningTimeLeft -= m_dt;
-      m_miningTimeTotal += m_dt;
-      if (m_miningTimeLeft <= 0) {
-        m_state = TruckState::TRAVELING_TO_STATION;
-        m_isMining = false;
-        m_isTravelingToStation = true;
-        m_miningTimeLeft = (int)getRandomMiningTime() / m_dt;
-        m_travelTimeLeft = TRAVEL_TIME / m_dt;
-      }
+      m_miningTicks = ticksOf((int)nextMiningTime());
+      transition(TruckState::TRAVELING_TO_STATION, tick);
       break;
     case TruckState::TRAVELING_TO_STATION:
-      m_travelTimeLeft -= m_dt;
-      m_travelTimeTotal += m_dt;
-      if (m_travelTimeLeft <= 0) {
-        m_state = TruckState::UNLOADING;
-        m_isTravelingToStation = false;
-        m_isUnloading = true;
-        m_unloadTimeLeft = UNLOAD_TIME / m_dt;
-      }
+      transition(TruckState::UNLOADING, tick);
       break;
     case TruckState::UNLOADING:
-      m_unloadTimeLeft -= m_dt;
-      m_unloadTimeTotal += m_dt;
-      if (m_unloadTimeLeft <= 0) {
-        m_state = TruckState::TRAVELING_TO_SITE;
-        // We want the unload station to set the transition from unload to
-        // traveling to the site
-        m_isUnloading = false;
-        m_isTravelingToSite = true;
-        m_travelTimeLeft = TRAVEL_TIME / m_dt;
+      // We want the unload station to set the transition from unload to
+      // traveling to the site
+      transition(TruckState::TRAVELING_TO_SITE, tick);
+      m_tripsCompleted++;
+      if (histograms != nullptr) {
+        histograms->queueWait.recordSeconds(m_queueWait);
       }
+      m_queueWait = 0;
       break;
     case TruckState::TRAVELING_TO_SITE:
-      m_travelTimeLeft -= m_dt;
-      m_travelTimeTotal += m_dt;
-      if (m_travelTimeLeft <= 0) {
-        m_state = TruckState::MINING;
-        m_isTravelingToSite = false;
-        m_isMining = true;
+      transition(TruckState::MINING, tick);
+      if (histograms != nullptr) {
+        histograms->cycleTime.recordSeconds((tick - m_cycleStart) * m_dt);
       }
+      m_cycleStart = tick;
       break;
     case TruckState::IDLE:
-      m_idleTimeTotal += m_dt;
       break;
     }
   }
+
+  /// \brief Advances the truck by one timestep on its own; the simulation
+  /// instead expires trucks from its timing wheel
+  /// \param histograms Optional per-trip histograms to record into
+  void update(TripHistograms *histograms = nullptr) {
+    m_now++;
+    if (m_state != TruckState::IDLE && m_now >= m_deadline) {
+      expire(m_now, histograms);
+    }
+  }
 };
\ No newline at end of file
@@ -1,279 +1,760 @@
 #pragma once
 // Simulation class with ThreadPool integration
+#include "Dispatch.hpp"
+#include "Histogram.hpp"
 #include "Log.hpp"
+#include "MiningTrace.hpp"
+#include "Reduction.hpp"
 #include "Station.hpp"
 #include "ThreadPool.hpp"
+#include "TimingWheel.hpp"
 #include "Truck.hpp"
+#include "WarmupDetector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
 #include <iostream>
 #include <queue>
 #include <vector>
 #include <future>
 #include <iomanip>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+/// \brief Contents of the report printed by TruckSim::simulate()
+struct ReportOptions {
+  // Per-truck and per-station blocks; the summary alone scales to any fleet
+  bool fullDump = false;
+  // Number of worst trucks (idle time) and stations (utilization) listed
+  size_t topK = 5;
+};
+
+/// \brief Parameters of a single simulation run
+struct SimConfig {
+  uint32_t numTrucks = 4;
+  uint32_t numStations = 2;
+  int numThreads = 0; // 0 means use hardware_concurrency
+
+  // Seed shared by every truck stream; runs with the same seed use common
+  // random numbers. Unset means a fresh non-deterministic seed per run.
+  std::optional<uint64_t> seed = std::nullopt;
+  // Draw mirrored uniforms (1 - u), the antithetic twin of the seeded run
+  bool antithetic = false;
+  // Suppress informational logging (used for batches of replications)
+  bool quiet = false;
+
+  // Simulated time and the initial transient excluded from the statistics
+  double horizonSecs = 259200.0; // 72 hours
+  double warmupSecs = 0.0;
+  // Detect the end of the warm-up with MSER-5 instead of a fixed period; a
+  // pilot run over the first half of the horizon locates it, then the run
+  // truncates its statistics there as with a fixed warm-up
+  bool autoWarmup = false;
+
+  // Rule routing arriving trucks to stations
+  DispatchRule dispatch = DispatchRule::FIFO;
+
+  // Record thread-pool telemetry (see ThreadPool::telemetry())
+  bool poolTelemetry = false;
+
+  // Recorded mining durations replayed instead of the random streams (seed
+  // and antithetic are then unused); shared by every run of a batch
+  std::shared_ptr<const MiningTrace> trace = nullptr;
+
+  // Raised by another thread to abandon the run, which then throws
+  // SimulationCancelled (checked every statistics interval)
+  const std::atomic<bool> *cancel = nullptr;
+
+  ReportOptions report = {};
+};
+
+/// \brief Thrown by a run whose cancel flag was raised
+class SimulationCancelled : public std::runtime_error {
+public:
+  SimulationCancelled() : std::runtime_error("Simulation cancelled") {}
+};
+
+/// \brief Version of the simulation engine, part of the key of persisted
+/// results. Bump it whenever the results of a configuration change.
+inline constexpr uint32_t ENGINE_VERSION = 3;
+
+/// \brief Fleet and station totals produced by a simulation run
+struct SimResults {
+  uint32_t numTrucks = 0;
+  uint32_t numStations = 0;
+  double durationSecs = 0.0; // measured period, after the warm-up
+  double warmupSecs = 0.0;
+
+  double totalMiningTime = 0.0;
+  double totalUnloadTime = 0.0;
+  double totalTravelTime = 0.0;
+  double totalIdleTime = 0.0;
+  double totalStationOccupiedTime = 0.0;
+  uint64_t tripsCompleted = 0;
+
+  // Tail latencies, in seconds
+  PercentileSummary queueWait;   // per station visit
+  PercentileSummary cycleTime;   // per trip
+  PercentileSummary serviceTime; // per station visit
+  // False when the engine records no distributions (LaneSim)
+  bool hasPercentiles = true;
+
+  /// \brief Retrieves the summed time of every truck state
+  double totalOperationalTime() const {
+    return totalMiningTime + totalUnloadTime + totalTravelTime + totalIdleTime;
+  }
+
+  /// \brief Retrieves the percentage of truck time spent waiting for a station
+  double truckIdleRate() const {
+    double total = totalOperationalTime();
+    return total > 0.0 ? (totalIdleTime / total) * 100.0 : 0.0;
+  }
+
+  /// \brief Retrieves the percentage of station time spent unloading trucks
+  double stationUtilization() const {
+    double total = durationSecs * numStations;
+    return total > 0.0 ? (totalStationOccupiedTime / total) * 100.0 : 0.0;
+  }
+
+  /// \brief Retrieves the number of completed unloads per station
+  double throughputPerStation() const {
+    return numStations > 0 ? static_cast<double>(tripsCompleted) / numStations
+                           : 0.0;
+  }
+};
 
 class TruckSim {
 private:
   // Trucks and stations
   std::vector<Truck> m_trucks;
   std::vector<Station> m_unloadStations;
+  // Trucks waiting for any station (shared queue) or for a specific one
   std::queue<Truck*> m_waitingTrucks;
+  std::vector<std::deque<Truck*>> m_stationQueues;
+  // Deadlines of the timed truck states; a tick only visits the trucks whose
+  // state ends on it
+  TimingWheel m_wheel;
+  std::vector<uint32_t> m_expiring;
+  std::vector<Truck*> m_arrivals;
   uint32_t m_numTrucks;
   uint32_t m_numStations;
   double m_currTime = 0;
+  uint64_t m_tick = 0;
+  uint64_t m_durationTicks;
+  uint64_t m_warmupTicks;
+  uint64_t m_statsStartTick = 0; // tick at which statistics were last reset
+  SimConfig m_config;
+  uint64_t m_seed;
 
   // Efficiency metrics
-  float m_totalMiningTime = 0.0f;
-  float m_totalUnloadTime = 0.0f;
-  float m_totalTravelTime = 0.0f;
-  float m_totalIdleTime = 0.0f;
-  float m_totalOperationalTime = 0.0f;
-  float m_totalStationOccupiedTime = 0.0f;
-  float m_totalStationIdleTime = 0.0f;
+  double m_totalMiningTime = 0.0;
+  double m_totalUnloadTime = 0.0;
+  double m_totalTravelTime = 0.0;
+  double m_totalIdleTime = 0.0;
+  double m_totalOperationalTime = 0.0;
+  double m_totalStationOccupiedTime = 0.0;
+  double m_totalStationIdleTime = 0.0;
+  SimResults m_results;
+
+  // Histograms: one padded set per worker (plus one for the calling thread),
+  // merged into m_tripHistograms once the run is over
+  std::vector<TripHistograms> m_workerHistograms;
+  TripHistograms m_tripHistograms;
+  Histogram m_serviceTimes;
+
+  // Automatic warm-up detection on the per-interval fleet idle fraction, fed
+  // by the pilot run only
+  WarmupDetector m_warmupDetector;
+  bool m_detectWarmup = false;
   
   // Time step variables
   static inline constexpr float dt = 1.0f; // s
-  static inline constexpr float SIMULATION_DURATION = 259200.0f / dt;
+  // The cancel flag is checked, and the warm-up pilot samples its series,
+  // at this interval
+  static inline constexpr uint64_t STATS_INTERVAL = 900.0f / dt;
+  // Expiring trucks per pool task; smaller batches are expired inline. A
+  // truck expires about 4 times per ~4 h cycle, so the pool only takes part
+  // from some 128 expiries per tick, i.e. fleets of roughly half a million
+  // trucks; below that, -p only speeds up the final reductions
+  static inline constexpr size_t PARALLEL_GRAIN = 64;
+  // Minimum trucks per pool task of the final reductions
+  static inline constexpr size_t REDUCTION_GRAIN = 4096;
   
-  // Thread pool
-  ThreadPool m_threadPool;
+  // Thread pool, absent when the simulation runs on the calling thread
+  std::unique_ptr<ThreadPool> m_threadPool;
 
 public:
   TruckSim(int numTrucks, int numStations, int numThreads = 0)
-      : m_numTrucks(numTrucks), m_numStations(numStations),
-        m_threadPool(numThreads > 0 ? numThreads : std::thread::hardware_concurrency()) {
+      : TruckSim(SimConfig{.numTrucks = static_cast<uint32_t>(numTrucks),
+                           .numStations = static_cast<uint32_t>(numStations),
+                           .numThreads = numThreads}) {}
+
+  explicit TruckSim(const SimConfig &config)
+      : m_wheel(config.numTrucks), m_numTrucks(config.numTrucks),
+        m_numStations(config.numStations),
+        m_durationTicks(static_cast<uint64_t>(std::llround(config.horizonSecs / dt))),
+        m_warmupTicks(static_cast<uint64_t>(std::llround(config.warmupSecs / dt))),
+        m_config(config),
+        m_seed(config.seed ? *config.seed : RandomStream::randomSeed()) {
+    // A single thread updates the trucks inline instead of through a pool,
+    // so batches of small runs do not pay for a thread per simulation
+    size_t numThreads = config.numThreads > 0 ? config.numThreads : std::thread::hardware_concurrency();
+    if (numThreads > 1) {
+      m_threadPool = std::make_unique<ThreadPool>(numThreads, config.poolTelemetry);
+    }
+
     // Pre-allocate vectors to avoid resizing
-    m_trucks.reserve(numTrucks);
-    m_unloadStations.reserve(numStations);
+    m_trucks.reserve(m_numTrucks);
+    m_unloadStations.reserve(m_numStations);
     
-    // Initialize trucks and unload stations
-    for (int i = 0; i < numTrucks; i++) {
-      m_trucks.emplace_back(i, dt);
+    // Initialize trucks and unload stations. Every truck owns the stream
+    // (seed, truck id), shared by all runs with the same seed, or replays
+    // its sequence of the trace
+    for (uint32_t i = 0; i < m_numTrucks; i++) {
+      if (config.trace) {
+        m_trucks.emplace_back(
+            i, dt, config.trace->getDurations(i % config.trace->getNumTrucks()));
+      } else {
+        m_trucks.emplace_back(i, dt, m_seed, config.antithetic);
+      }
+      m_wheel.schedule(i, m_trucks.back().getDeadline());
     }
-    for (int i = 0; i < numStations; i++) {
+    for (uint32_t i = 0; i < m_numStations; i++) {
       m_unloadStations.emplace_back(i, dt);
     }
+    m_stationQueues.resize(m_numStations);
+    m_workerHistograms.resize(getNumThreads() + 1);
     
-    Logger::LOGI("Initialized simulation with " + std::to_string(numTrucks) + 
-                " trucks, " + std::to_string(numStations) + " stations, and " + 
-                std::to_string(m_threadPool.size()) + " worker threads");
+    if (!m_config.quiet) {
+      Logger::LOGI("Initialized simulation with " + std::to_string(m_numTrucks) + 
+                  " trucks, " + std::to_string(m_numStations) + " stations, and " + 
+                  std::to_string(getNumThreads()) + " worker threads");
+    }
   }
 
   uint32_t getNumTrucks() const { return m_numTrucks; }
   uint32_t getNumStations() const { return m_numStations; }
+  uint64_t getSeed() const { return m_seed; }
+  uint64_t getDurationTicks() const { return m_durationTicks; }
+  /// \brief Retrieves the time step of every simulation, in seconds
+  static constexpr float getTimeStep() { return dt; }
+  size_t getNumThreads() const { return m_threadPool ? m_threadPool->size() : 1; }
+  const SimResults &getResults() const { return m_results; }
+  /// \brief Retrieves the telemetry of the thread pool (empty without a pool
+  /// or with telemetry off)
+  PoolTelemetry getPoolTelemetry() const {
+    return m_threadPool ? m_threadPool->telemetry() : PoolTelemetry();
+  }
+  const TripHistograms &getTripHistograms() const { return m_tripHistograms; }
+  const Histogram &getServiceTimes() const { return m_serviceTimes; }
 
+  /// \brief Runs the simulation and prints the report, built in memory and
+  /// written at once
   void simulate() {
-    Logger::LOGI("Starting simulation...");
+    run();
+
+    std::ostringstream report;
+    if (m_config.report.fullDump) {
+      printTruckStats(report);
+      printStationStats(report);
+    }
+    printEfficiencyStats(report);
+    printFleetSummary(report);
+    std::cout << report.str() << std::flush;
+    
+    Logger::LOGI("Simulation completed");
+  }
+
+  /// \brief Runs the simulation without printing and returns its totals,
+  /// dispatching with the policy selected in the configuration
+  const SimResults &run() {
+    if (m_config.autoWarmup && !m_detectWarmup && m_tick == 0) {
+      m_warmupTicks = detectWarmupTicks();
+    }
+    switch (m_config.dispatch) {
+    case DispatchRule::SHORTEST_QUEUE:
+      return runWith<ShortestQueueDispatch>();
+    case DispatchRule::LEAST_WAIT:
+      return runWith<LeastWaitDispatch>();
+    case DispatchRule::ROUND_ROBIN:
+      return runWith<RoundRobinDispatch>();
+    case DispatchRule::FIFO:
+    default:
+      return runWith<FifoDispatch>();
+    }
+  }
+
+  /// \brief Runs the simulation with a given dispatch policy, which is
+  /// inlined into the assignment step
+  template <DispatchPolicy Policy>
+  const SimResults &runWith() {
+    if (!m_config.quiet) {
+      Logger::LOGI(std::string("Starting simulation (dispatch: ") +
+                   Policy::NAME + ")...");
+    }
+    Policy policy;
 
     // Continue in while loop until we reach end time in increments of dt
-    while (m_currTime < SIMULATION_DURATION) {
+    while (m_tick < m_durationTicks) {
+      m_tick++;
       m_currTime += dt;
       
       // Update stations (not parallelized due to potential race conditions)
       for (auto &station : m_unloadStations) {
-        station.update();
+        station.update(&m_serviceTimes);
       }
 
-      // Process trucks in parallel using the thread pool
-      std::vector<std::future<void>> updateFutures;
-      updateFutures.reserve(m_trucks.size());
-      
-      // Submit truck updates to thread pool
-      for (auto &truck : m_trucks) {
-        updateFutures.push_back(
-          m_threadPool.enqueue([&truck]() {
-            truck.update();
-          })
-        );
-      }
-      
-      // Wait for all truck updates to complete
-      for (auto &future : updateFutures) {
-        future.wait();
-      }
+      // Advance the trucks whose current state ends on this tick
+      expireTrucks();
 
       // Maintain truck-station assignments (not parallelized due to shared resource access)
-      assignTrucksToStations();
+      assignTrucksToStations(policy);
+
+      if (m_tick % STATS_INTERVAL == 0) {
+        if (m_config.cancel && m_config.cancel->load(std::memory_order_relaxed)) {
+          throw SimulationCancelled();
+        }
+        // Only the pilot needs per-interval windows; otherwise the trucks
+        // are accounted once, at the warm-up reset and at the end
+        if (m_detectWarmup) {
+          flushStatistics();
+        }
+      }
+      if (m_tick == m_warmupTicks) {
+        resetStatistics();
+      }
     }
+    flushStatistics();
     
+    // Combine the per-worker histograms
+    m_tripHistograms.reset();
+    for (auto &histograms : m_workerHistograms) {
+      m_tripHistograms.merge(histograms);
+    }
+
     calculateEfficiencyMetrics();
-    printTruckStats();
-    printStationStats();
-    printEfficiencyStats();
-    
-    Logger::LOGI("Simulation completed");
+    return m_results;
   }
 
 private:
-  void assignTrucksToStations() {
-    // Collect all trucks that need a station
-    std::vector<Truck*> trucksNeedingStation;
-    
+  // Expires the trucks due on the current tick, in parallel when there are
+  // enough of them, then schedules their next deadline. Trucks arriving at
+  // the stations are left to the assignment step.
+  void expireTrucks() {
+    m_expiring.clear();
+    m_wheel.advance([this](uint32_t id) { m_expiring.push_back(id); });
+
+    size_t numExpiring = m_expiring.size();
+    size_t numChunks = m_threadPool ? std::min(m_threadPool->size(),
+                                               numExpiring / PARALLEL_GRAIN)
+                                    : 0;
+    if (numChunks > 1) {
+      size_t chunkSize = (numExpiring + numChunks - 1) / numChunks;
+      std::vector<std::future<void>> expireFutures;
+      expireFutures.reserve(numChunks);
+      for (size_t begin = 0; begin < numExpiring; begin += chunkSize) {
+        size_t end = std::min(begin + chunkSize, numExpiring);
+        expireFutures.push_back(m_threadPool->enqueue([this, begin, end]() {
+          TripHistograms *histograms =
+              &m_workerHistograms[m_threadPool->currentWorkerIndex()];
+          for (size_t i = begin; i < end; ++i) {
+            m_trucks[m_expiring[i]].expire(m_tick, histograms);
+          }
+        }));
+      }
+      for (auto &future : expireFutures) {
+        future.wait();
+      }
+    } else {
+      for (uint32_t id : m_expiring) {
+        m_trucks[id].expire(m_tick, &m_workerHistograms.back());
+      }
+    }
+
+    for (uint32_t id : m_expiring) {
+      Truck &truck = m_trucks[id];
+      if (truck.getState() == TruckState::UNLOADING) {
+        m_arrivals.push_back(&truck);
+      } else {
+        m_wheel.schedule(id, truck.getDeadline());
+      }
+    }
+  }
+
+  // Moves the per-truck accumulators into their totals and, in the pilot run,
+  // feeds each full interval's fleet idle fraction to MSER-5 (a serial pass
+  // over the fleet, so regular runs only do it at the end)
+  void flushStatistics() {
+    TruckTotals window;
     for (auto &truck : m_trucks) {
-      if ((truck.getState() == TruckState::UNLOADING || 
-           truck.getState() == TruckState::IDLE) && 
-          !truck.hasStation()) {
-        trucksNeedingStation.push_back(&truck);
+      window += truck.flushStats(m_tick);
+    }
+
+    if (m_detectWarmup && m_tick % STATS_INTERVAL == 0 && window.sum() > 0.0) {
+      m_warmupDetector.add(window.idle / window.sum());
+    }
+  }
+
+  // Replays the first half of the horizon with the same seed, trace and
+  // dispatch, and returns the MSER-5 truncation point in ticks (0 when no
+  // warm-up was detected). The point lies on a batch boundary of the idle
+  // series, so the run then cuts its statistics exactly there.
+  uint64_t detectWarmupTicks() {
+    SimConfig pilotConfig = m_config;
+    pilotConfig.seed = m_seed;
+    pilotConfig.quiet = true;
+    pilotConfig.autoWarmup = false;
+    pilotConfig.warmupSecs = 0.0;
+    pilotConfig.horizonSecs = (m_durationTicks / 2) * dt;
+    TruckSim pilot(pilotConfig);
+    pilot.m_detectWarmup = true;
+    pilot.run();
+
+    std::optional<uint64_t> truncation = pilot.m_warmupDetector.truncationPoint();
+    uint64_t warmupTicks = truncation ? *truncation * STATS_INTERVAL : 0;
+    if (!m_config.quiet) {
+      if (warmupTicks > 0) {
+        Logger::LOGI("Warm-up detected at " +
+                     std::to_string(static_cast<uint64_t>(warmupTicks * dt)) + "s");
+      } else {
+        Logger::LOGI("No warm-up detected, statistics cover the whole horizon");
       }
     }
-    
-    // Find available stations
-    std::vector<Station*> availableStations;
-    
+    return warmupTicks;
+  }
+
+  // Discards everything accumulated so far (end of the warm-up period)
+  void resetStatistics() {
+    for (auto &truck : m_trucks) {
+      truck.resetStats(m_tick);
+    }
     for (auto &station : m_unloadStations) {
-      if (station.getTruckInStation() == nullptr) {
-        availableStations.push_back(&station);
+      station.resetStats();
+    }
+    for (auto &histograms : m_workerHistograms) {
+      histograms.reset();
+    }
+    m_serviceTimes.reset();
+    m_statsStartTick = m_tick;
+  }
+
+  template <DispatchPolicy Policy>
+  void assignTrucksToStations(Policy &policy) {
+    DispatchContext context{m_unloadStations, m_stationQueues};
+
+    // Route the trucks that just arrived, in fleet order; they wait until a
+    // station takes them
+    std::sort(m_arrivals.begin(), m_arrivals.end());
+    for (Truck *truck : m_arrivals) {
+      size_t station = m_numStations > 0 ? policy.route(*truck, context)
+                                         : DispatchContext::ANY_STATION;
+      if (station < m_numStations) {
+        m_stationQueues[station].push_back(truck);
+      } else {
+        m_waitingTrucks.push(truck);
       }
+      truck->setState(TruckState::IDLE, m_tick);
     }
+    m_arrivals.clear();
     
-    // Match trucks to stations efficiently
-    size_t numAssignments = std::min(trucksNeedingStation.size(), availableStations.size());
-    
-    for (size_t i = 0; i < numAssignments; ++i) {
-      Truck* truck = trucksNeedingStation[i];
-      Station* station = availableStations[i];
-      
-      // Update truck state if it was waiting
-      if (truck->getState() == TruckState::IDLE) {
-        truck->setState(TruckState::UNLOADING);
+    // Every free station takes the head of its own queue, or else the head
+    // of the shared queue
+    for (size_t i = 0; i < m_numStations; ++i) {
+      Station &station = m_unloadStations[i];
+      if (station.getTruckInStation() != nullptr) {
+        continue;
       }
-      
+
+      Truck *truck = nullptr;
+      if (!m_stationQueues[i].empty()) {
+        truck = m_stationQueues[i].front();
+        m_stationQueues[i].pop_front();
+      } else if (!m_waitingTrucks.empty()) {
+        truck = m_waitingTrucks.front();
+        m_waitingTrucks.pop();
+      } else {
+        continue;
+      }
+
       // Assign truck to station
+      truck->setState(TruckState::UNLOADING, m_tick);
       truck->setHasStation(true);
-      station->setTruckInStation(truck);
-    }
-    
-    // Set remaining trucks to IDLE if they need a station but none available
-    for (size_t i = numAssignments; i < trucksNeedingStation.size(); ++i) {
-      trucksNeedingStation[i]->setState(TruckState::IDLE);
+      station.setTruckInStation(truck);
+      m_wheel.schedule(static_cast<uint32_t>(truck - m_trucks.data()),
+                       truck->getDeadline());
     }
   }
 
+  // Per-chunk fleet totals of the final reduction
+  struct FleetSums {
+    KahanSum mining;
+    KahanSum unload;
+    KahanSum travel;
+    KahanSum idle;
+    uint64_t trips = 0;
+  };
+
   void calculateEfficiencyMetrics() {
-    // Initialize totals
-    m_totalMiningTime = 0.0f;
-    m_totalUnloadTime = 0.0f;
-    m_totalTravelTime = 0.0f;
-    m_totalIdleTime = 0.0f;
-    
-    // Sum all time components from trucks
-    for (auto &truck : m_trucks) {
-      m_totalMiningTime += truck.getMiningTimeTotal() * dt;
-      m_totalUnloadTime += truck.getUnloadTimeTotal() * dt;
-      m_totalTravelTime += truck.getTravelTimeTotal() * dt;
-      m_totalIdleTime += truck.getIdleTimeTotal() * dt;
-    }
+    // Sum all time components from trucks, in parallel chunks with
+    // compensated double sums
+    FleetSums fleet = parallelReduce<FleetSums>(
+        m_threadPool.get(), m_trucks.size(), REDUCTION_GRAIN,
+        [this](size_t begin, size_t end) {
+          FleetSums sums;
+          for (size_t i = begin; i < end; ++i) {
+            const Truck &truck = m_trucks[i];
+            sums.mining.add(truck.getMiningTimeTotal() * dt);
+            sums.unload.add(truck.getUnloadTimeTotal() * dt);
+            sums.travel.add(truck.getTravelTimeTotal() * dt);
+            sums.idle.add(truck.getIdleTimeTotal() * dt);
+            sums.trips += truck.getTripsCompleted();
+          }
+          return sums;
+        },
+        [](FleetSums &total, const FleetSums &partial) {
+          total.mining += partial.mining;
+          total.unload += partial.unload;
+          total.travel += partial.travel;
+          total.idle += partial.idle;
+          total.trips += partial.trips;
+        });
+    m_totalMiningTime = fleet.mining.get();
+    m_totalUnloadTime = fleet.unload.get();
+    m_totalTravelTime = fleet.travel.get();
+    m_totalIdleTime = fleet.idle.get();
     
     // Calculate station efficiency
-    m_totalStationOccupiedTime = 0.0f;
+    KahanSum occupied;
     for (auto &station : m_unloadStations) {
-      m_totalStationOccupiedTime += station.getTimeOccupied();
+      occupied.add(station.getTimeOccupied());
     }
+    m_totalStationOccupiedTime = occupied.get();
     
     // Total possible station operational time
-    float totalPossibleStationTime = SIMULATION_DURATION * dt * m_numStations;
+    double measuredSecs = (m_durationTicks - m_statsStartTick) * dt;
+    double totalPossibleStationTime = measuredSecs * m_numStations;
     m_totalStationIdleTime = totalPossibleStationTime - m_totalStationOccupiedTime;
     
     // Calculate total operational time across all trucks
     m_totalOperationalTime = m_totalMiningTime + m_totalUnloadTime + m_totalTravelTime + m_totalIdleTime;
+
+    m_results.numTrucks = m_numTrucks;
+    m_results.numStations = m_numStations;
+    m_results.durationSecs = measuredSecs;
+    m_results.warmupSecs = m_statsStartTick * dt;
+    m_results.totalMiningTime = m_totalMiningTime;
+    m_results.totalUnloadTime = m_totalUnloadTime;
+    m_results.totalTravelTime = m_totalTravelTime;
+    m_results.totalIdleTime = m_totalIdleTime;
+    m_results.totalStationOccupiedTime = m_totalStationOccupiedTime;
+    m_results.tripsCompleted = fleet.trips;
+    m_results.queueWait = PercentileSummary::of(m_tripHistograms.queueWait);
+    m_results.cycleTime = PercentileSummary::of(m_tripHistograms.cycleTime);
+    m_results.serviceTime = PercentileSummary::of(m_serviceTimes);
   }
 
-  void printTruckStats() {
-    std::cout << "=== TRUCK STATISTICS ===" << std::endl;
+  void printTruckStats(std::ostream &out) {
+    out << "=== TRUCK STATISTICS ===" << '\n';
     for (auto &truck : m_trucks) {
-      std::cout << "Truck ID " << truck.getId() << std::endl;
+      out << "Truck ID " << truck.getId() << '\n';
 
       // Multiply the times by dt to report values in seconds
-      std::cout << "Mining Time Total: " << truck.getMiningTimeTotal() * dt
-                << "s" << std::endl;
-      std::cout << "Unload Time Total: " << truck.getUnloadTimeTotal() * dt
-                << "s" << std::endl;
-      std::cout << "Travel Time Total: " << truck.getTravelTimeTotal() * dt
-                << "s" << std::endl;
-      std::cout << "Idle Time Total: " << truck.getIdleTimeTotal() * dt << "s"
-                << std::endl;
-
-      std::cout << "Total Time: "
-                << (truck.getMiningTimeTotal() * dt) +
-                       (truck.getUnloadTimeTotal() * dt) +
-                       (truck.getTravelTimeTotal() * dt) +
-                       (truck.getIdleTimeTotal() * dt)
-                << "s" << std::endl;
-      std::cout << std::endl;
+      out << "Mining Time Total: " << truck.getMiningTimeTotal() * dt
+          << "s" << '\n';
+      out << "Unload Time Total: " << truck.getUnloadTimeTotal() * dt
+          << "s" << '\n';
+      out << "Travel Time Total: " << truck.getTravelTimeTotal() * dt
+          << "s" << '\n';
+      out << "Idle Time Total: " << truck.getIdleTimeTotal() * dt << "s"
+          << '\n';
+
+      out << "Total Time: "
+          << (truck.getMiningTimeTotal() * dt) +
+                 (truck.getUnloadTimeTotal() * dt) +
+                 (truck.getTravelTimeTotal() * dt) +
+                 (truck.getIdleTimeTotal() * dt)
+          << "s" << '\n';
+      out << '\n';
     }
   }
 
-  void printStationStats() {
-    std::cout << "=== STATION STATISTICS ===" << std::endl;
+  void printStationStats(std::ostream &out) {
+    out << "=== STATION STATISTICS ===" << '\n';
     for (auto &station : m_unloadStations) {
-      std::cout << "Station " << station.getId() << " stats:" << std::endl;
-      std::cout << "Time occupied: " << station.getTimeOccupied() << "s" << std::endl;
+      out << "Station " << station.getId() << " stats:" << '\n';
+      out << "Time occupied: " << station.getTimeOccupied() << "s" << '\n';
 
       std::unordered_map<uint32_t, float> truckTimes = station.getTruckTimes();
 
       for (auto &truck : truckTimes) {
-        std::cout << "Truck ID: " << truck.first << " time: " << truck.second
-                  << "s" << std::endl;
+        out << "Truck ID: " << truck.first << " time: " << truck.second
+            << "s" << '\n';
       }
-      std::cout << std::endl;
+      out << '\n';
     }
   }
   
-  void printEfficiencyStats() {
-    std::cout << "=== EFFICIENCY STATISTICS ===" << std::endl;
-    std::cout << std::fixed << std::setprecision(2);
+  void printPercentiles(std::ostream &out, const std::string &name,
+                        const PercentileSummary &summary) {
+    out << name << ": " << summary.p50 << "s / " << summary.p90
+        << "s / " << summary.p99 << "s / " << summary.max << "s ("
+        << summary.count << " samples)" << '\n';
+  }
+
+  // Prints min / p50 / p90 / p99 / max of a sample, reordering it
+  static void printDistribution(std::ostream &out, const std::string &name,
+                                std::vector<double> &values,
+                                const std::string &unit) {
+    if (values.empty()) {
+      return;
+    }
+    auto quantile = [&values](double q) {
+      auto nth = values.begin() + static_cast<size_t>(q * (values.size() - 1));
+      std::nth_element(values.begin(), nth, values.end());
+      return *nth;
+    };
+    out << name << ": " << quantile(0.0) << unit << " / " << quantile(0.5)
+        << unit << " / " << quantile(0.9) << unit << " / " << quantile(0.99)
+        << unit << " / " << quantile(1.0) << unit << '\n';
+  }
+
+  // Prints the per-truck and per-station distributions and the worst
+  // entities instead of one block per entity
+  void printFleetSummary(std::ostream &out) {
+    double measuredSecs = m_results.durationSecs;
+    std::vector<double> truckIdle(m_trucks.size());
+    std::vector<double> truckIdleRate(m_trucks.size());
+    std::vector<double> truckTrips(m_trucks.size());
+    for (size_t i = 0; i < m_trucks.size(); ++i) {
+      const Truck &truck = m_trucks[i];
+      double total = truck.getMiningTimeTotal() + truck.getUnloadTimeTotal() +
+                     truck.getTravelTimeTotal() + truck.getIdleTimeTotal();
+      truckIdle[i] = truck.getIdleTimeTotal() * dt;
+      truckIdleRate[i] = total > 0.0 ? truck.getIdleTimeTotal() / total * 100.0 : 0.0;
+      truckTrips[i] = truck.getTripsCompleted();
+    }
+    std::vector<double> stationUtilization(m_unloadStations.size());
+    for (size_t i = 0; i < m_unloadStations.size(); ++i) {
+      stationUtilization[i] =
+          measuredSecs > 0.0
+              ? m_unloadStations[i].getTimeOccupied() / measuredSecs * 100.0
+              : 0.0;
+    }
+
+    // Worst entities, ranked before the distributions reorder the samples
+    size_t topTrucks = std::min(m_config.report.topK, m_trucks.size());
+    std::vector<size_t> truckOrder(m_trucks.size());
+    std::iota(truckOrder.begin(), truckOrder.end(), 0);
+    std::partial_sort(truckOrder.begin(), truckOrder.begin() + topTrucks,
+                      truckOrder.end(), [&truckIdle](size_t a, size_t b) {
+                        return truckIdle[a] > truckIdle[b] ||
+                               (truckIdle[a] == truckIdle[b] && a < b);
+                      });
+    size_t topStations = std::min(m_config.report.topK, m_unloadStations.size());
+    std::vector<size_t> stationOrder(m_unloadStations.size());
+    std::iota(stationOrder.begin(), stationOrder.end(), 0);
+    std::partial_sort(stationOrder.begin(), stationOrder.begin() + topStations,
+                      stationOrder.end(),
+                      [&stationUtilization](size_t a, size_t b) {
+                        return stationUtilization[a] < stationUtilization[b] ||
+                               (stationUtilization[a] == stationUtilization[b] &&
+                                a < b);
+                      });
+
+    out << '\n' << "=== TOP " << topTrucks << " TRUCKS BY IDLE TIME ===" << '\n';
+    for (size_t k = 0; k < topTrucks; ++k) {
+      size_t i = truckOrder[k];
+      out << "Truck ID " << m_trucks[i].getId() << ": " << truckIdle[i]
+          << "s idle (" << truckIdleRate[i] << "%), "
+          << m_trucks[i].getTripsCompleted() << " trips" << '\n';
+    }
+    out << '\n' << "=== TOP " << topStations << " LEAST UTILIZED STATIONS ===" << '\n';
+    for (size_t k = 0; k < topStations; ++k) {
+      size_t i = stationOrder[k];
+      out << "Station " << m_unloadStations[i].getId() << ": "
+          << stationUtilization[i] << "% utilized, "
+          << m_unloadStations[i].getTimeOccupied() << "s occupied" << '\n';
+    }
+
+    out << '\n' << "=== FLEET DISTRIBUTION ===" << '\n';
+    out << "(min / p50 / p90 / p99 / max)" << '\n';
+    printDistribution(out, "Truck Idle Rate", truckIdleRate, "%");
+    printDistribution(out, "Truck Trips", truckTrips, "");
+    printDistribution(out, "Station Utilization", stationUtilization, "%");
+  }
+
+  void printEfficiencyStats(std::ostream &out) {
+    out << "=== EFFICIENCY STATISTICS ===" << '\n';
+    out << std::fixed << std::setprecision(2);
     
     // Print overall time breakdown
-    float simDurationSecs = SIMULATION_DURATION * dt;
-    std::cout << "Simulation Duration: " << simDurationSecs << "s (" 
-              << simDurationSecs / 3600.0f << " hours)" << std::endl;
-    std::cout << std::endl;
+    double simDurationSecs = m_results.durationSecs;
+    out << "Simulation Duration: " << simDurationSecs << "s (" 
+        << simDurationSecs / 3600.0f << " hours)" << '\n';
+    if (m_results.warmupSecs > 0.0) {
+      out << "Warm-up Truncated: " << m_results.warmupSecs << "s ("
+          << m_results.warmupSecs / 3600.0 << " hours)" << '\n';
+    }
+    out << '\n';
     
     // Fleet statistics
-    std::cout << "Fleet Statistics:" << std::endl;
-    std::cout << "Total Mining Time: " << m_totalMiningTime << "s (" 
-              << (m_totalMiningTime / m_totalOperationalTime) * 100.0f << "%)" << std::endl;
-    std::cout << "Total Travel Time: " << m_totalTravelTime << "s (" 
-              << (m_totalTravelTime / m_totalOperationalTime) * 100.0f << "%)" << std::endl;
-    std::cout << "Total Unload Time: " << m_totalUnloadTime << "s (" 
-              << (m_totalUnloadTime / m_totalOperationalTime) * 100.0f << "%)" << std::endl;
-    std::cout << "Total Idle Time: " << m_totalIdleTime << "s (" 
-              << (m_totalIdleTime / m_totalOperationalTime) * 100.0f << "%)" << std::endl;
-    std::cout << std::endl;
+    out << "Fleet Statistics:" << '\n';
+    out << "Total Mining Time: " << m_totalMiningTime << "s (" 
+        << (m_totalMiningTime / m_totalOperationalTime) * 100.0f << "%)" << '\n';
+    out << "Total Travel Time: " << m_totalTravelTime << "s (" 
+        << (m_totalTravelTime / m_totalOperationalTime) * 100.0f << "%)" << '\n';
+    out << "Total Unload Time: " << m_totalUnloadTime << "s (" 
+        << (m_totalUnloadTime / m_totalOperationalTime) * 100.0f << "%)" << '\n';
+    out << "Total Idle Time: " << m_totalIdleTime << "s (" 
+        << (m_totalIdleTime / m_totalOperationalTime) * 100.0f << "%)" << '\n';
+    out << '\n';
     
     // Average per truck
-    std::cout << "Average Per Truck:" << std::endl;
-    std::cout << "Avg Mining Time: " << m_totalMiningTime / m_numTrucks << "s" << std::endl;
-    std::cout << "Avg Travel Time: " << m_totalTravelTime / m_numTrucks << "s" << std::endl;
-    std::cout << "Avg Unload Time: " << m_totalUnloadTime / m_numTrucks << "s" << std::endl;
-    std::cout << "Avg Idle Time: " << m_totalIdleTime / m_numTrucks << "s" << std::endl;
-    std::cout << std::endl;
+    out << "Average Per Truck:" << '\n';
+    out << "Avg Mining Time: " << m_totalMiningTime / m_numTrucks << "s" << '\n';
+    out << "Avg Travel Time: " << m_totalTravelTime / m_numTrucks << "s" << '\n';
+    out << "Avg Unload Time: " << m_totalUnloadTime / m_numTrucks << "s" << '\n';
+    out << "Avg Idle Time: " << m_totalIdleTime / m_numTrucks << "s" << '\n';
+    out << '\n';
     
     // Station Utilization
-    float stationUtilization = (m_totalStationOccupiedTime / (simDurationSecs * m_numStations)) * 100.0f;
-    std::cout << "Station Utilization:" << std::endl;
-    std::cout << "Total Station Occupied Time: " << m_totalStationOccupiedTime << "s" << std::endl;
-    std::cout << "Total Station Idle Time: " << m_totalStationIdleTime << "s" << std::endl;
-    std::cout << "Station Utilization Rate: " << stationUtilization << "%" << std::endl;
-    std::cout << std::endl;
+    double stationUtilization = (m_totalStationOccupiedTime / (simDurationSecs * m_numStations)) * 100.0f;
+    out << "Station Utilization:" << '\n';
+    out << "Total Station Occupied Time: " << m_totalStationOccupiedTime << "s" << '\n';
+    out << "Total Station Idle Time: " << m_totalStationIdleTime << "s" << '\n';
+    out << "Station Utilization Rate: " << stationUtilization << "%" << '\n';
+    out << '\n';
+
+    // Tail latencies
+    out << "Percentiles (p50 / p90 / p99 / max):" << '\n';
+    printPercentiles(out, "Queue Wait", m_results.queueWait);
+    printPercentiles(out, "Cycle Time", m_results.cycleTime);
+    printPercentiles(out, "Station Service", m_results.serviceTime);
+    out << '\n';
     
     // Overall efficiency metrics
-    float truckIdleRate = (m_totalIdleTime / m_totalOperationalTime) * 100.0f;
-    float truckProductiveRate = 100.0f - truckIdleRate;
+    double truckIdleRate = (m_totalIdleTime / m_totalOperationalTime) * 100.0f;
+    double truckProductiveRate = 100.0 - truckIdleRate;
     
-    std::cout << "Overall Efficiency Metrics:" << std::endl;
-    std::cout << "Truck Productive Time Rate: " << truckProductiveRate << "%" << std::endl;
-    std::cout << "Truck Idle Time Rate: " << truckIdleRate << "%" << std::endl;
-    std::cout << "Station Utilization Rate: " << stationUtilization << "%" << std::endl;
+    out << "Overall Efficiency Metrics:" << '\n';
+    out << "Truck Productive Time Rate: " << truckProductiveRate << "%" << '\n';
+    out << "Truck Idle Time Rate: " << truckIdleRate << "%" << '\n';
+    out << "Station Utilization Rate: " << stationUtilization << "%" << '\n';
     
     // Calculate system bottleneck
-    std::cout << std::endl << "System Analysis:" << std::endl;
+    out << '\n' << "System Analysis:" << '\n';
     if (truckIdleRate > (100.0f - stationUtilization)) {
-      std::cout << "BOTTLENECK: Insufficient unloading stations - trucks waiting too long" << std::endl;
-      std::cout << "RECOMMENDATION: Add more unloading stations" << std::endl;
+      out << "BOTTLENECK: Insufficient unloading stations - trucks waiting too long" << '\n';
+      out << "RECOMMENDATION: Add more unloading stations" << '\n';
     } else if (stationUtilization < 70.0f) {
-      std::cout << "BOTTLENECK: Too many unloading stations - stations underutilized" << std::endl;
-      std::cout << "RECOMMENDATION: Reduce number of stations or add more trucks" << std::endl;
+      out << "BOTTLENECK: Too many unloading stations - stations underutilized" << '\n';
+      out << "RECOMMENDATION: Reduce number of stations or add more trucks" << '\n';
     } else {
-      std::cout << "System appears well-balanced" << std::endl;
+      out << "System appears well-balanced" << '\n';
     }
     
     // Calculate optimal ratio
@@ -290,7 +771,7 @@ private:
       optimalRatio = currentRatio;
     }
     
-    std::cout << "Current Truck:Station Ratio: " << currentRatio << std::endl;
-    std::cout << "Estimated Optimal Ratio: " << optimalRatio << std::endl;
+    out << "Current Truck:Station Ratio: " << currentRatio << '\n';
+    out << "Estimated Optimal Ratio: " << optimalRatio << '\n';
   }
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+/// \brief Online MSER-5 warm-up detection over a bounded-memory series.
+///
+/// Observations are averaged in batches of 5 (MSER-5). The batch means are
+/// kept in a fixed-capacity series; once it is full, adjacent entries are
+/// merged and every entry covers twice as many observations, so memory stays
+/// flat for any run length. The truncation point is the d minimizing
+///   MSER(d) = sum_{j > d} (Z_j - mean_d)^2 / (k - d)^2
+/// over the first half of the k batch means Z_j.
+class WarmupDetector {
+public:
+  static constexpr uint32_t BATCH_SIZE = 5;
+  static constexpr size_t MAX_BATCHES = 256;
+  static constexpr size_t MIN_BATCHES = 8;
+
+private:
+  std::vector<double> m_batchMeans;
+  uint64_t m_observationsPerEntry = BATCH_SIZE;
+  uint64_t m_observations = 0;
+  double m_pendingSum = 0.0;
+  uint64_t m_pendingCount = 0;
+
+  void compact() {
+    size_t half = m_batchMeans.size() / 2;
+    for (size_t i = 0; i < half; ++i) {
+      m_batchMeans[i] =
+          0.5 * (m_batchMeans[2 * i] + m_batchMeans[2 * i + 1]);
+    }
+    m_batchMeans.resize(half);
+    m_observationsPerEntry *= 2;
+  }
+
+public:
+  WarmupDetector() { m_batchMeans.reserve(MAX_BATCHES); }
+
+  /// \brief Adds the next observation of the output series
+  void add(double observation) {
+    m_observations++;
+    m_pendingSum += observation;
+    if (++m_pendingCount == m_observationsPerEntry) {
+      if (m_batchMeans.size() == MAX_BATCHES) {
+        compact();
+      }
+      m_batchMeans.push_back(m_pendingSum / m_pendingCount);
+      m_pendingSum = 0.0;
+      m_pendingCount = 0;
+    }
+  }
+
+  /// \brief Retrieves the number of observations added so far
+  uint64_t getObservations() const { return m_observations; }
+
+  /// \brief Retrieves the number of batch means currently stored
+  size_t getBatchCount() const { return m_batchMeans.size(); }
+
+  /// \brief Computes the MSER-5 truncation point, in observations.
+  /// \return Nothing while the series is too short, or when the minimum lies
+  /// at the edge of the searched half (the run is too short to tell)
+  std::optional<uint64_t> truncationPoint() const {
+    size_t k = m_batchMeans.size();
+    if (k < MIN_BATCHES) {
+      return std::nullopt;
+    }
+
+    // Suffix sums give mean and squared deviation of Z_{d+1..k} in O(1)
+    std::vector<double> suffixSum(k + 1, 0.0), suffixSq(k + 1, 0.0);
+    for (size_t j = k; j-- > 0;) {
+      suffixSum[j] = suffixSum[j + 1] + m_batchMeans[j];
+      suffixSq[j] = suffixSq[j + 1] + m_batchMeans[j] * m_batchMeans[j];
+    }
+
+    size_t best = 0;
+    double bestValue = std::numeric_limits<double>::max();
+    for (size_t d = 0; d <= k / 2; ++d) {
+      double n = static_cast<double>(k - d);
+      double mean = suffixSum[d] / n;
+      double squares = suffixSq[d] - n * mean * mean;
+      double value = squares / (n * n);
+      if (value < bestValue) {
+        bestValue = value;
+        best = d;
+      }
+    }
+
+    if (best == k / 2) {
+      return std::nullopt;
+    }
+    return static_cast<uint64_t>(best) * m_observationsPerEntry;
+  }
+};
@@ -1,15 +1,81 @@
+#include "Benchmark.hpp"
+#include "Comparison.hpp"
+#include "Optimizer.hpp"
+#include "ResultCache.hpp"
+#include "SimServer.hpp"
 #include "ThreadPool.hpp"
 #include "Station.hpp"
 #include "Truck.hpp"
 #include "TruckSim.hpp"
+#include <atomic>
 #include <cerrno>
+#include <csignal>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <string>
 #include <chrono>
 #include "Log.hpp"
 
+namespace {
+// Raised by SIGINT / SIGTERM to stop the server
+std::atomic<bool> g_stopServer{false};
+
+void requestServerStop(int) { g_stopServer = true; }
+
+// Parses a bound of the optimizer search, a count from 1 to UINT32_MAX
+std::optional<uint32_t> parseSearchBound(const std::string &text) {
+  if (text.empty() || text[0] == '-') {
+    return std::nullopt;
+  }
+  unsigned long value = std::stoul(text);
+  if (value == 0 || value > std::numeric_limits<uint32_t>::max()) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(value);
+}
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " <options>" << std::endl;
+  std::cerr << "Options:" << std::endl;
+  std::cerr << "  -t <num>     Number of trucks (default: 4)" << std::endl;
+  std::cerr << "  -s <num>     Number of stations (default: 2)" << std::endl;
+  std::cerr << "  -p <num>     Threads of the pool (default: hardware concurrency); no effect on a single run below ~500k trucks, used by -c, --optimize and --serve" << std::endl;
+  std::cerr << "  -d <hours>   Simulated horizon (default: 72)" << std::endl;
+  std::cerr << "  -w <hours|auto>  Warm-up excluded from the statistics, auto detects it with MSER-5 (default: 0)" << std::endl;
+  std::cerr << "  -v           Verbose mode" << std::endl;
+  std::cerr << "  --full-report        Print the statistics of every truck and station" << std::endl;
+  std::cerr << "  --top <num>          Worst trucks and stations listed in the report (default: 5)" << std::endl;
+  std::cerr << "  -b           Benchmark mode, same as --bench strong" << std::endl;
+  std::cerr << "  --bench <strong|weak>         Scaling benchmark: fixed fleet, or fleet and stations per thread" << std::endl;
+  std::cerr << "  --bench-threads <list>        Comma-separated thread counts (default: 1,2,4,hardware concurrency)" << std::endl;
+  std::cerr << "  --trials <num>                Timed trials per thread count (default: 5)" << std::endl;
+  std::cerr << "  --bench-warmup <num>          Untimed warm-up trials per thread count (default: 1)" << std::endl;
+  std::cerr << "  --bench-format <csv|json>     Output format of the benchmark (default: csv)" << std::endl;
+  std::cerr << "  --bench-telemetry             Record thread-pool counters and print them after the benchmark" << std::endl;
+  std::cerr << "  --seed <num> Seed of the mining-duration streams (default: random)" << std::endl;
+  std::cerr << "  --trace <file>       Replay the mining durations recorded in a trace file" << std::endl;
+  std::cerr << "  --serve <socket>     Serve simulation requests on a Unix domain socket until interrupted" << std::endl;
+  std::cerr << "  --serve-queue <num>  Configurations in flight before requests are rejected (default: 64 per thread)" << std::endl;
+  std::cerr << "  --dispatch <rule>    Dispatch rule: fifo, shortest-queue, least-wait, round-robin (default: fifo)" << std::endl;
+  std::cerr << "  -c <num>     Compare against this number of stations (paired replications)" << std::endl;
+  std::cerr << "  --compare-dispatch <rule>    Compare against this dispatch rule (paired replications)" << std::endl;
+  std::cerr << "  -r <num>     Replications of a comparison or optimization point (default: 10)" << std::endl;
+  std::cerr << "  --lanes <0|8>        Replications stepped together from event to event in one engine (default: 8, 0 disables)" << std::endl;
+  std::cerr << "  --cache <file>       Reuse results of identical seeded replications across runs (created if missing)" << std::endl;
+  std::cerr << "  --antithetic Use antithetic replication pairs in a comparison" << std::endl;
+  std::cerr << "  --no-crn     Use independent streams for the compared configuration" << std::endl;
+  std::cerr << "  --optimize <stations|trucks>  Find the minimum stations (or trucks) meeting the constraints" << std::endl;
+  std::cerr << "  --max-idle <pct>              Constraint: maximum truck idle rate" << std::endl;
+  std::cerr << "  --min-util <pct>              Constraint: minimum station utilization" << std::endl;
+  std::cerr << "  --min-throughput <trips>      Constraint: minimum trips per station" << std::endl;
+  std::cerr << "  --search-min <num>            Lower bound of the search (default: 1)" << std::endl;
+  std::cerr << "  --search-max <num>            Upper bound of the search (default: trucks, or 64 x stations)" << std::endl;
+}
+} // namespace
+
 int main(int argc, char *argv[]) {
   // Default configuration
   int numTrucks = 4;
@@ -17,16 +83,27 @@ int main(int argc, char *argv[]) {
   int numThreads = 0; // 0 means use hardware_concurrency
   bool verbose = false;
   bool benchmarkMode = false;
+  BenchmarkOptions benchmark;
+  std::optional<uint64_t> seed;
+  double horizonHours = 72.0;
+  double warmupHours = 0.0;
+  bool autoWarmup = false;
+  int compareStations = 0; // 0 means no paired comparison
+  DispatchRule dispatch = DispatchRule::FIFO;
+  std::optional<DispatchRule> compareDispatch;
+  ComparisonOptions comparison;
+  bool optimizeMode = false;
+  OptimizerOptions optimizer;
+  OptimizerConstraints constraints;
+  std::string tracePath;
+  std::string cachePath;
+  std::string servePath;
+  uint32_t serveQueue = 0;
+  ReportOptions report;
 
   // Allow command-line configuration
   if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <options>" << std::endl;
-    std::cerr << "Options:" << std::endl;
-    std::cerr << "  -t <num>     Number of trucks (default: 4)" << std::endl;
-    std::cerr << "  -s <num>     Number of stations (default: 2)" << std::endl;
-    std::cerr << "  -p <num>     Number of threads in the thread pool (default: hardware concurrency)" << std::endl;
-    std::cerr << "  -v           Verbose mode" << std::endl;
-    std::cerr << "  -b           Benchmark mode (run with different thread counts)" << std::endl;
+    printUsage(argv[0]);
     return 1;
   }
 
@@ -41,46 +118,284 @@ int main(int argc, char *argv[]) {
     else if (arg == "-p" && i + 1 < argc) {
       numThreads = std::stoi(argv[++i]);
     }
+    else if (arg == "-d" && i + 1 < argc) {
+      horizonHours = std::stod(argv[++i]);
+    }
+    else if (arg == "-w" && i + 1 < argc) {
+      std::string warmup = argv[++i];
+      if (warmup == "auto") {
+        autoWarmup = true;
+      } else {
+        warmupHours = std::stod(warmup);
+        if (warmupHours < 0.0) {
+          std::cerr << "Warm-up must not be negative: " << warmup << std::endl;
+          return 1;
+        }
+      }
+    }
     else if (arg == "-v") {
       verbose = true;
     }
     else if (arg == "-b") {
       benchmarkMode = true;
     }
+    else if (arg == "--bench" && i + 1 < argc) {
+      benchmarkMode = true;
+      std::optional<BenchmarkOptions::Scaling> scaling = Benchmark::parseScaling(argv[++i]);
+      if (!scaling) {
+        std::cerr << "Unknown benchmark scaling: " << argv[i] << std::endl;
+        return 1;
+      }
+      benchmark.scaling = *scaling;
+    }
+    else if (arg == "--bench-threads" && i + 1 < argc) {
+      benchmark.threadCounts = Benchmark::parseThreadCounts(argv[++i]);
+    }
+    else if (arg == "--trials" && i + 1 < argc) {
+      benchmark.trials = std::stoi(argv[++i]);
+    }
+    else if (arg == "--bench-warmup" && i + 1 < argc) {
+      benchmark.warmupTrials = std::stoi(argv[++i]);
+    }
+    else if (arg == "--bench-format" && i + 1 < argc) {
+      std::optional<BenchmarkOptions::Format> format = Benchmark::parseFormat(argv[++i]);
+      if (!format) {
+        std::cerr << "Unknown benchmark format: " << argv[i] << std::endl;
+        return 1;
+      }
+      benchmark.format = *format;
+    }
+    else if (arg == "--bench-telemetry") {
+      benchmark.telemetry = true;
+    }
+    else if (arg == "--full-report") {
+      report.fullDump = true;
+    }
+    else if (arg == "--top" && i + 1 < argc) {
+      report.topK = std::stoul(argv[++i]);
+    }
+    else if (arg == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    }
+    else if (arg == "--seed" && i + 1 < argc) {
+      seed = std::stoull(argv[++i]);
+    }
+    else if ((arg == "--dispatch" || arg == "--compare-dispatch") && i + 1 < argc) {
+      std::optional<DispatchRule> rule = parseDispatchRule(argv[++i]);
+      if (!rule) {
+        std::cerr << "Unknown dispatch rule: " << argv[i] << std::endl;
+        return 1;
+      }
+      if (arg == "--dispatch") {
+        dispatch = *rule;
+      } else {
+        compareDispatch = rule;
+      }
+    }
+    else if (arg == "-c" && i + 1 < argc) {
+      compareStations = std::stoi(argv[++i]);
+    }
+    else if (arg == "-r" && i + 1 < argc) {
+      comparison.replications = std::stoi(argv[++i]);
+    }
+    else if (arg == "--lanes" && i + 1 < argc) {
+      comparison.lanes = static_cast<uint32_t>(std::stoul(argv[++i]));
+      if (comparison.lanes != 0 && comparison.lanes != 8) {
+        std::cerr << "Unsupported number of lanes: " << argv[i]
+                  << " (expected 0 or 8)" << std::endl;
+        return 1;
+      }
+    }
+    else if (arg == "--serve" && i + 1 < argc) {
+      servePath = argv[++i];
+    }
+    else if (arg == "--serve-queue" && i + 1 < argc) {
+      serveQueue = static_cast<uint32_t>(std::stoul(argv[++i]));
+    }
+    else if (arg == "--cache" && i + 1 < argc) {
+      cachePath = argv[++i];
+    }
+    else if (arg == "--antithetic") {
+      comparison.antithetic = true;
+    }
+    else if (arg == "--no-crn") {
+      comparison.commonRandomNumbers = false;
+    }
+    else if (arg == "--optimize" && i + 1 < argc) {
+      optimizeMode = true;
+      std::string target = argv[++i];
+      if (target != "stations" && target != "trucks") {
+        std::cerr << "Unknown optimization target: " << target << std::endl;
+        printUsage(argv[0]);
+        return 1;
+      }
+      optimizer.target = target == "trucks" ? OptimizeTarget::TRUCKS
+                                            : OptimizeTarget::STATIONS;
+    }
+    else if (arg == "--max-idle" && i + 1 < argc) {
+      constraints.maxIdleRate = std::stod(argv[++i]);
+    }
+    else if (arg == "--min-util" && i + 1 < argc) {
+      constraints.minStationUtilization = std::stod(argv[++i]);
+    }
+    else if (arg == "--min-throughput" && i + 1 < argc) {
+      constraints.minThroughputPerStation = std::stod(argv[++i]);
+    }
+    else if ((arg == "--search-min" || arg == "--search-max") && i + 1 < argc) {
+      std::optional<uint32_t> bound = parseSearchBound(argv[++i]);
+      if (!bound) {
+        std::cerr << "Invalid " << arg << ": " << argv[i]
+                  << " (expected 1 to " << std::numeric_limits<uint32_t>::max()
+                  << ")" << std::endl;
+        return 1;
+      }
+      (arg == "--search-min" ? optimizer.lowerBound : optimizer.upperBound) = *bound;
+    }
+  }
+
+  if (optimizer.upperBound != 0 && optimizer.upperBound < optimizer.lowerBound) {
+    std::cerr << "--search-max (" << optimizer.upperBound << ") must not be below --search-min ("
+              << optimizer.lowerBound << ")" << std::endl;
+    return 1;
+  }
+
+  // A warm-up covering the whole horizon would leave nothing to measure
+  if (!autoWarmup && warmupHours >= horizonHours) {
+    std::cerr << "Warm-up (" << warmupHours << "h) must be shorter than the horizon ("
+              << horizonHours << "h)" << std::endl;
+    return 1;
+  }
+
+  SimConfig config;
+  config.numTrucks = numTrucks;
+  config.numStations = numStations;
+  config.numThreads = numThreads;
+  config.seed = seed;
+  config.horizonSecs = horizonHours * 3600.0;
+  config.warmupSecs = warmupHours * 3600.0;
+  config.autoWarmup = autoWarmup;
+  config.dispatch = dispatch;
+  config.report = report;
+  if (!tracePath.empty()) {
+    try {
+      config.trace = std::make_shared<MiningTrace>(tracePath);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  std::unique_ptr<ResultCache> cache;
+  if (!cachePath.empty()) {
+    try {
+      cache = std::make_unique<ResultCache>(cachePath);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    comparison.cache = cache.get();
+    optimizer.cache = cache.get();
+  }
+
+  if (!servePath.empty()) {
+    ServerOptions serverOptions;
+    serverOptions.socketPath = servePath;
+    serverOptions.numWorkers = numThreads > 0 ? numThreads : 0;
+    serverOptions.maxInFlight = serveQueue;
+    serverOptions.cache = cache.get();
+    serverOptions.stop = &g_stopServer;
+    try {
+      SimServer server(serverOptions);
+      std::signal(SIGINT, requestServerStop);
+      std::signal(SIGTERM, requestServerStop);
+      std::cerr << "Serving on " << servePath << " with "
+                << server.getNumWorkers() << " workers, up to "
+                << server.getMaxInFlight() << " configurations in flight"
+                << std::endl;
+      server.run();
+      std::cerr << "Served " << server.getServed() << " configurations"
+                << std::endl;
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (benchmarkMode) {
+    // Machine-readable output only, so results can be tracked across releases
+    Benchmark bench(config, benchmark);
+    bench.run();
+    bench.print(std::cout);
+    return 0;
   }
 
   // Print configuration
   std::cout << "=== LUNAR HELIUM-3 MINING SIMULATION ===" << std::endl;
   std::cout << "Number of Mining Trucks: " << numTrucks << std::endl;
   std::cout << "Number of Unload Stations: " << numStations << std::endl;
+  std::cout << "Horizon: " << horizonHours << " hours" << std::endl;
+  std::cout << "Dispatch Rule: " << dispatchRuleName(dispatch) << std::endl;
+  if (config.trace) {
+    std::cout << "Mining Trace: " << tracePath << " ("
+              << config.trace->getNumTrucks() << " recorded trucks)" << std::endl;
+  }
   
-  if (benchmarkMode) {
-    // Run the simulation with different thread counts to benchmark
-    std::cout << "\n=== STARTING BENCHMARK MODE ===" << std::endl;
-    std::cout << "Running simulation with varying thread counts..." << std::endl;
-    
-    // Thread counts to test (1, 2, 4, hardware_concurrency)
-    std::vector<int> threadCounts = {1, 2, 4, (int)std::thread::hardware_concurrency()};
-    
-    for (int threads : threadCounts) {
-      std::cout << "\nRunning with " << threads << " threads:" << std::endl;
-      
-      // Measure execution time
-      auto startTime = std::chrono::high_resolution_clock::now();
-      
-      // Run the simulation
-      TruckSim sim(numTrucks, numStations, threads);
-      sim.simulate();
-      
-      auto endTime = std::chrono::high_resolution_clock::now();
-      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-          endTime - startTime).count();
-      
-      std::cout << "Execution time: " << duration << " ms" << std::endl;
+  if (optimizeMode) {
+    optimizer.replications = comparison.replications;
+    optimizer.lanes = comparison.lanes;
+    optimizer.baseSeed = seed ? *seed : RandomStream::randomSeed();
+    optimizer.parallelism = numThreads > 0 ? numThreads : 0;
+    std::cout << std::endl;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    Optimizer search(config, constraints, optimizer);
+    std::optional<uint32_t> solution = search.solve();
+    search.printReport(solution);
+    if (cache) {
+      std::cout << "Result cache: " << cache->getHits() << " hits, "
+                << cache->getMisses() << " misses" << std::endl;
     }
-    
-    std::cout << "\n=== BENCHMARK COMPLETE ===" << std::endl;
-  } 
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        endTime - startTime).count();
+
+    std::cout << "\nExecution time: " << duration << " ms" << std::endl;
+  }
+  else if (compareStations > 0 || compareDispatch) {
+    // Paired replications of the current configuration (A) against the same
+    // fleet with a different number of stations or dispatch rule (B)
+    SimConfig configB = config;
+    if (compareStations > 0) {
+      configB.numStations = compareStations;
+      std::cout << "Compared Unload Stations: " << compareStations << std::endl;
+    }
+    if (compareDispatch) {
+      configB.dispatch = *compareDispatch;
+      std::cout << "Compared Dispatch Rule: " << dispatchRuleName(*compareDispatch) << std::endl;
+    }
+    comparison.parallelism = numThreads > 0 ? numThreads : 0;
+    comparison.baseSeed = seed ? *seed : RandomStream::randomSeed();
+    std::cout << std::endl;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    Comparison compare(config, configB, comparison);
+    compare.run();
+    compare.printReport();
+    if (cache) {
+      std::cout << "\nResult cache: " << cache->getHits() << " hits, "
+                << cache->getMisses() << " misses" << std::endl;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        endTime - startTime).count();
+
+    std::cout << "\nExecution time: " << duration << " ms" << std::endl;
+  }
   else {
     // Standard simulation run
     if (numThreads > 0) {
@@ -94,8 +409,9 @@ int main(int argc, char *argv[]) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
     // Run the simulation
-    TruckSim sim(numTrucks, numStations, numThreads);
+    TruckSim sim(config);
     sim.simulate();
+    std::cout << "Seed: " << sim.getSeed() << std::endl;
     
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
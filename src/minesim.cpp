@@ -0,0 +1,185 @@
+// C API of the simulation library, see minesim.h
+#include "minesim.h"
+#include "CApi.hpp"
+#include "ResultCache.hpp"
+#include "ThreadPool.hpp"
+#include "TruckSim.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace {
+
+// Long-lived pool shared by every batch
+std::mutex g_poolMutex;
+std::shared_ptr<ThreadPool> g_pool;
+
+// Optional persistent result cache shared by every batch
+std::mutex g_cacheMutex;
+std::shared_ptr<ResultCache> g_cache;
+
+std::shared_ptr<ResultCache> acquireCache() {
+  std::lock_guard<std::mutex> lock(g_cacheMutex);
+  return g_cache;
+}
+
+std::shared_ptr<ThreadPool> acquirePool() {
+  std::lock_guard<std::mutex> lock(g_poolMutex);
+  if (!g_pool) {
+    g_pool = std::make_shared<ThreadPool>();
+  }
+  return g_pool;
+}
+
+// Runs one configuration on the calling worker thread, unless the cache
+// holds its results
+void runOne(const minesim_config &config, minesim_result &result,
+            ResultCache *cache) {
+  result = minesim_result{};
+  result.num_trucks = config.num_trucks;
+  result.num_stations = config.num_stations;
+  result.status = validateConfig(config);
+  if (result.status != MINESIM_OK) {
+    return;
+  }
+
+  SimConfig simConfig = toSimConfig(config);
+  try {
+    std::optional<SimResults> cached =
+        cache ? cache->find(simConfig, true) : std::nullopt;
+    SimResults sim = cached ? *cached : TruckSim(simConfig).run();
+    if (cache && !cached) {
+      cache->insert(simConfig, sim);
+    }
+    fillResult(sim, result);
+  } catch (...) {
+    result.status = MINESIM_ERR_INTERNAL;
+  }
+}
+
+} // namespace
+
+extern "C" {
+
+int minesim_api_version(void) { return MINESIM_API_VERSION; }
+
+void minesim_config_init(minesim_config *config) {
+  if (config == nullptr) {
+    return;
+  }
+  *config = minesim_config{};
+  config->num_trucks = 4;
+  config->num_stations = 2;
+  config->seed = 1;
+  config->horizon_secs = 259200.0;
+}
+
+int minesim_init(uint32_t num_workers) {
+  std::lock_guard<std::mutex> lock(g_poolMutex);
+  if (g_pool) {
+    return MINESIM_ERR_INVALID_ARGUMENT;
+  }
+  try {
+    g_pool = std::make_shared<ThreadPool>(
+        num_workers > 0 ? num_workers : std::thread::hardware_concurrency());
+  } catch (...) {
+    return MINESIM_ERR_INTERNAL;
+  }
+  return MINESIM_OK;
+}
+
+int minesim_run_batch(const minesim_config *configs, size_t n,
+                      minesim_result *results_out) {
+  if (n == 0) {
+    return MINESIM_OK;
+  }
+  if (configs == nullptr || results_out == nullptr) {
+    return MINESIM_ERR_INVALID_ARGUMENT;
+  }
+
+  try {
+    // Holding a reference keeps the pool alive through a concurrent shutdown
+    std::shared_ptr<ThreadPool> pool = acquirePool();
+    std::shared_ptr<ResultCache> cache = acquireCache();
+
+    // One task per worker, each pulling the next configuration, so a batch
+    // of millions of entries costs a handful of queue operations
+    std::atomic<size_t> next{0};
+    size_t numTasks = std::min(n, pool->size());
+    std::vector<std::future<void>> futures;
+    futures.reserve(numTasks);
+    for (size_t t = 0; t < numTasks; ++t) {
+      futures.push_back(pool->enqueue([&]() {
+        for (size_t i = next++; i < n; i = next++) {
+          runOne(configs[i], results_out[i], cache.get());
+        }
+      }));
+    }
+    for (auto &future : futures) {
+      future.get();
+    }
+  } catch (...) {
+    return MINESIM_ERR_INTERNAL;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    if (results_out[i].status != MINESIM_OK) {
+      return results_out[i].status;
+    }
+  }
+  return MINESIM_OK;
+}
+
+void minesim_shutdown(void) {
+  std::shared_ptr<ThreadPool> pool;
+  {
+    std::lock_guard<std::mutex> lock(g_poolMutex);
+    pool.swap(g_pool);
+  }
+  // The pool joins its workers once the last running batch releases it
+}
+
+int minesim_cache_open(const char *path) {
+  if (path == nullptr) {
+    return MINESIM_ERR_INVALID_ARGUMENT;
+  }
+  try {
+    auto cache = std::make_shared<ResultCache>(path);
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    g_cache = std::move(cache);
+  } catch (...) {
+    return MINESIM_ERR_INTERNAL;
+  }
+  return MINESIM_OK;
+}
+
+void minesim_cache_close(void) {
+  std::shared_ptr<ResultCache> cache;
+  {
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
+    cache.swap(g_cache);
+  }
+  // Batches still running keep their reference until they finish
+}
+
+const char *minesim_status_string(int status) {
+  switch (status) {
+  case MINESIM_OK:
+    return "ok";
+  case MINESIM_ERR_INVALID_ARGUMENT:
+    return "invalid argument";
+  case MINESIM_ERR_INTERNAL:
+    return "internal error";
+  case MINESIM_ERR_BUSY:
+    return "server busy";
+  case MINESIM_ERR_CANCELLED:
+    return "cancelled";
+  default:
+    return "unknown status";
+  }
+}
+
+} // extern "C"
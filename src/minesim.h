@@ -0,0 +1,122 @@
+#ifndef MINESIM_H
+#define MINESIM_H
+
+/*
+ * C API of the lunar mining simulation library (libminesim).
+ *
+ * Configurations are evaluated in batches on a long-lived worker pool owned
+ * by the library, and results are written straight into caller-provided
+ * buffers. All structs are plain data passed in arrays, so their layout is
+ * part of the ABI: MINESIM_API_VERSION changes whenever a struct or status
+ * code does, and callers must be rebuilt against the matching header. A
+ * caller can compare minesim_api_version() with MINESIM_API_VERSION at
+ * start-up to detect a stale build.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MINESIM_API_VERSION 4
+
+/* Status codes */
+#define MINESIM_OK 0
+#define MINESIM_ERR_INVALID_ARGUMENT -1
+#define MINESIM_ERR_INTERNAL -2
+#define MINESIM_ERR_BUSY -3      /* rejected by admission control */
+#define MINESIM_ERR_CANCELLED -4 /* cancelled by the client */
+
+/* Dispatch rules */
+#define MINESIM_DISPATCH_FIFO 0
+#define MINESIM_DISPATCH_SHORTEST_QUEUE 1
+#define MINESIM_DISPATCH_LEAST_WAIT 2
+#define MINESIM_DISPATCH_ROUND_ROBIN 3
+
+typedef struct minesim_config {
+  uint32_t num_trucks;
+  uint32_t num_stations;
+  uint64_t seed;       /* runs sharing a seed use common random numbers */
+  double horizon_secs; /* simulated time */
+  double warmup_secs;  /* initial period excluded from the statistics */
+  int32_t auto_warmup; /* nonzero: detect the warm-up with MSER-5 */
+  int32_t antithetic;  /* nonzero: draw mirrored uniforms */
+  int32_t dispatch;    /* MINESIM_DISPATCH_* */
+} minesim_config;
+
+typedef struct minesim_percentiles {
+  uint64_t count;
+  uint64_t p50;
+  uint64_t p90;
+  uint64_t p99;
+  uint64_t max;
+} minesim_percentiles;
+
+typedef struct minesim_result {
+  int32_t status; /* MINESIM_OK or the error of this configuration */
+  uint32_t num_trucks;
+  uint32_t num_stations;
+  double duration_secs; /* measured period, after the warm-up */
+  double warmup_secs;
+  double total_mining_time;
+  double total_unload_time;
+  double total_travel_time;
+  double total_idle_time;
+  double total_station_occupied_time;
+  uint64_t trips_completed;
+  double truck_idle_rate;     /* % of truck time */
+  double station_utilization; /* % of station time */
+  double throughput_per_station;
+  minesim_percentiles queue_wait;   /* seconds, per station visit */
+  minesim_percentiles cycle_time;   /* seconds, per trip */
+  minesim_percentiles service_time; /* seconds, per station visit */
+} minesim_result;
+
+/* Returns MINESIM_API_VERSION of the library. */
+int minesim_api_version(void);
+
+/* Fills a configuration with the defaults (4 trucks, 2 stations, 72 hours). */
+void minesim_config_init(minesim_config *config);
+
+/*
+ * Starts the worker pool with the given number of threads (0 means one per
+ * hardware thread). Optional: the first batch starts a default pool. Returns
+ * MINESIM_ERR_INVALID_ARGUMENT if the pool is already running.
+ */
+int minesim_init(uint32_t num_workers);
+
+/*
+ * Evaluates n configurations in parallel and writes one result per
+ * configuration into results_out, which must hold n entries. Blocks until
+ * the whole batch is done. Returns MINESIM_OK when every configuration
+ * succeeded, otherwise the first failing status (each result carries its
+ * own status).
+ */
+int minesim_run_batch(const minesim_config *configs, size_t n,
+                      minesim_result *results_out);
+
+/* Stops the worker pool; a later batch starts a new one. */
+void minesim_shutdown(void);
+
+/*
+ * Opens (or creates) a persistent result cache consulted by every later
+ * batch: configurations already stored are answered without simulating,
+ * new results are appended. Replaces any cache already open. Returns
+ * MINESIM_ERR_INVALID_ARGUMENT for a null path and MINESIM_ERR_INTERNAL if
+ * the file cannot be opened.
+ */
+int minesim_cache_open(const char *path);
+
+/* Closes the result cache, if open. */
+void minesim_cache_close(void);
+
+/* Returns a static description of a status code. */
+const char *minesim_status_string(int status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MINESIM_H */
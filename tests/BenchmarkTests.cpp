@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../src/Benchmark.hpp"
+#include <vector>
+
+// Test the interpolated quantiles on known samples
+TEST(BenchmarkTest, Quantiles) {
+    std::vector<double> sorted = {10.0, 20.0, 30.0, 40.0, 50.0};
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(sorted, 0.5), 30.0);
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(sorted, 0.25), 20.0);
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(sorted, 0.0), 10.0);
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(sorted, 1.0), 50.0);
+
+    // Between two samples the quantile is interpolated linearly
+    std::vector<double> even = {1.0, 2.0, 3.0, 4.0};
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(even, 0.5), 2.5);
+    EXPECT_DOUBLE_EQ(Benchmark::quantile(even, 0.75), 3.25);
+
+    EXPECT_DOUBLE_EQ(Benchmark::quantile({7.0}, 0.9), 7.0);
+    EXPECT_DOUBLE_EQ(Benchmark::quantile({}, 0.5), 0.0);
+}
+
+// Test that the timings and rates of a row come from unsorted trials
+TEST(BenchmarkTest, Summarize) {
+    BenchmarkRow row;
+    row.threads = 2;
+    row.trucks = 100;
+    row.ticks = 3600;
+    Benchmark::summarize(row, {400.0, 200.0, 300.0, 500.0, 100.0});
+
+    EXPECT_DOUBLE_EQ(row.medianMs, 300.0);
+    EXPECT_DOUBLE_EQ(row.q1Ms, 200.0);
+    EXPECT_DOUBLE_EQ(row.q3Ms, 400.0);
+    // 3600 ticks in 0.3 s
+    EXPECT_DOUBLE_EQ(row.ticksPerSec, 12000.0);
+}
+
+// Test the strong and weak efficiencies on known timings
+TEST(BenchmarkTest, Efficiency) {
+    BenchmarkRow base;
+    base.threads = 1;
+    base.medianMs = 800.0;
+    BenchmarkRow row;
+    row.threads = 4;
+    row.medianMs = 250.0;
+
+    // Strong: a speedup of 3.2 on 4 threads
+    EXPECT_DOUBLE_EQ(Benchmark::efficiency(BenchmarkOptions::Scaling::STRONG, base, row), 0.8);
+    // Weak: 4 times the work in 250 ms instead of 800 ms
+    EXPECT_DOUBLE_EQ(Benchmark::efficiency(BenchmarkOptions::Scaling::WEAK, base, row), 3.2);
+    EXPECT_DOUBLE_EQ(Benchmark::efficiency(BenchmarkOptions::Scaling::STRONG, base, base), 1.0);
+
+    // A base row that is not single-threaded scales its cost by its threads
+    base.threads = 2;
+    EXPECT_DOUBLE_EQ(Benchmark::efficiency(BenchmarkOptions::Scaling::STRONG, base, row), 1.6);
+}
+
+// Test the command-line names, unknown ones included
+TEST(BenchmarkTest, ParseOptions) {
+    EXPECT_EQ(Benchmark::parseScaling("strong"), BenchmarkOptions::Scaling::STRONG);
+    EXPECT_EQ(Benchmark::parseScaling("weak"), BenchmarkOptions::Scaling::WEAK);
+    EXPECT_FALSE(Benchmark::parseScaling("wek").has_value());
+    EXPECT_EQ(Benchmark::parseFormat("csv"), BenchmarkOptions::Format::CSV);
+    EXPECT_EQ(Benchmark::parseFormat("json"), BenchmarkOptions::Format::JSON);
+    EXPECT_FALSE(Benchmark::parseFormat("xml").has_value());
+    EXPECT_EQ(Benchmark::parseThreadCounts("1,2,,8"), (std::vector<int>{1, 2, 8}));
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "../src/minesim.h"
+#include "../src/TruckSim.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class CApiTest : public ::testing::Test {
+protected:
+    minesim_config shortRun(uint32_t trucks, uint32_t stations, uint64_t seed) {
+        minesim_config config;
+        minesim_config_init(&config);
+        config.num_trucks = trucks;
+        config.num_stations = stations;
+        config.seed = seed;
+        config.horizon_secs = 8.0 * 3600.0;
+        return config;
+    }
+};
+
+// Test that a batch matches the C++ simulation run by run
+TEST_F(CApiTest, BatchMatchesSimulation) {
+    std::vector<minesim_config> configs = {
+        shortRun(4, 1, 1), shortRun(4, 2, 1), shortRun(6, 1, 2), shortRun(2, 2, 3)};
+    std::vector<minesim_result> results(configs.size());
+
+    ASSERT_EQ(minesim_run_batch(configs.data(), configs.size(), results.data()),
+              MINESIM_OK);
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        SimConfig config;
+        config.numTrucks = configs[i].num_trucks;
+        config.numStations = configs[i].num_stations;
+        config.numThreads = 1;
+        config.seed = configs[i].seed;
+        config.quiet = true;
+        config.horizonSecs = configs[i].horizon_secs;
+        SimResults expected = TruckSim(config).run();
+
+        EXPECT_EQ(results[i].status, MINESIM_OK);
+        EXPECT_EQ(results[i].num_trucks, configs[i].num_trucks);
+        EXPECT_DOUBLE_EQ(results[i].duration_secs, expected.durationSecs);
+        EXPECT_DOUBLE_EQ(results[i].total_idle_time, expected.totalIdleTime);
+        EXPECT_EQ(results[i].trips_completed, expected.tripsCompleted);
+        EXPECT_EQ(results[i].queue_wait.p99, expected.queueWait.p99);
+    }
+}
+
+// Test that invalid configurations are reported per result
+TEST_F(CApiTest, InvalidConfiguration) {
+    std::vector<minesim_config> configs = {shortRun(2, 1, 1), shortRun(2, 1, 1)};
+    configs[1].warmup_secs = configs[1].horizon_secs;
+    std::vector<minesim_result> results(configs.size());
+
+    EXPECT_EQ(minesim_run_batch(configs.data(), configs.size(), results.data()),
+              MINESIM_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(results[0].status, MINESIM_OK);
+    EXPECT_EQ(results[1].status, MINESIM_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(minesim_run_batch(nullptr, 1, results.data()),
+              MINESIM_ERR_INVALID_ARGUMENT);
+}
+
+// Test that the pool can be restarted with an explicit size
+TEST_F(CApiTest, Restart) {
+    minesim_shutdown();
+    EXPECT_EQ(minesim_init(2), MINESIM_OK);
+    EXPECT_EQ(minesim_init(2), MINESIM_ERR_INVALID_ARGUMENT);
+
+    minesim_config config = shortRun(3, 1, 5);
+    minesim_result result;
+    EXPECT_EQ(minesim_run_batch(&config, 1, &result), MINESIM_OK);
+    EXPECT_GT(result.trips_completed, 0u);
+    minesim_shutdown();
+}
+
+// Test that a batch answered from the cache matches the simulated batch
+TEST_F(CApiTest, CachedBatch) {
+    std::string path = ::testing::TempDir() + "capi_cache.bin";
+    std::remove(path.c_str());
+    ASSERT_EQ(minesim_cache_open(path.c_str()), MINESIM_OK);
+
+    std::vector<minesim_config> configs = {shortRun(4, 1, 1), shortRun(5, 2, 7)};
+    std::vector<minesim_result> first(configs.size());
+    std::vector<minesim_result> second(configs.size());
+    ASSERT_EQ(minesim_run_batch(configs.data(), configs.size(), first.data()), MINESIM_OK);
+    ASSERT_EQ(minesim_run_batch(configs.data(), configs.size(), second.data()), MINESIM_OK);
+    minesim_cache_close();
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        EXPECT_EQ(second[i].total_idle_time, first[i].total_idle_time);
+        EXPECT_EQ(second[i].trips_completed, first[i].trips_completed);
+        EXPECT_EQ(second[i].cycle_time.p90, first[i].cycle_time.p90);
+        EXPECT_EQ(second[i].truck_idle_rate, first[i].truck_idle_rate);
+    }
+    EXPECT_EQ(minesim_cache_open(nullptr), MINESIM_ERR_INVALID_ARGUMENT);
+    std::remove(path.c_str());
+}
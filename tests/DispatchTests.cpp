@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../src/Dispatch.hpp"
+#include "../src/TruckSim.hpp"
+#include <deque>
+#include <vector>
+
+static_assert(DispatchPolicy<FifoDispatch>);
+static_assert(DispatchPolicy<ShortestQueueDispatch>);
+static_assert(DispatchPolicy<LeastWaitDispatch>);
+static_assert(DispatchPolicy<RoundRobinDispatch>);
+
+class DispatchTest : public ::testing::Test {
+protected:
+    float dt = 1.0f;
+    std::vector<Station> stations;
+    std::vector<std::deque<Truck*>> queues;
+    std::vector<Truck> trucks;
+
+    void SetUp() override {
+        for (int i = 0; i < 3; i++) {
+            stations.emplace_back(i, dt);
+        }
+        queues.resize(3);
+        for (int i = 0; i < 6; i++) {
+            trucks.emplace_back(i, dt, 1);
+        }
+    }
+
+    DispatchContext context() { return DispatchContext{stations, queues}; }
+};
+
+// Test that FIFO routes every truck to the shared queue
+TEST_F(DispatchTest, Fifo) {
+    FifoDispatch policy;
+    EXPECT_EQ(policy.route(trucks[0], context()), DispatchContext::ANY_STATION);
+}
+
+// Test that shortest-queue counts the truck in service
+TEST_F(DispatchTest, ShortestQueue) {
+    ShortestQueueDispatch policy;
+    stations[0].setTruckInStation(&trucks[0]);
+    queues[1].push_back(&trucks[1]);
+    queues[1].push_back(&trucks[2]);
+    EXPECT_EQ(policy.route(trucks[3], context()), 2u);
+
+    stations[2].setTruckInStation(&trucks[4]);
+    queues[2].push_back(&trucks[5]);
+    EXPECT_EQ(policy.route(trucks[3], context()), 0u);
+}
+
+// Test that least-wait accounts for the remaining unload in service
+TEST_F(DispatchTest, LeastWait) {
+    LeastWaitDispatch policy;
+    for (int i = 0; i < 3; i++) {
+        trucks[i].setState(TruckState::UNLOADING);
+        stations[i].setTruckInStation(&trucks[i]);
+    }
+    // Station 1 has the truck closest to done unloading
+    for (int tick = 0; tick < 100; tick++) {
+        stations[1].update();
+    }
+    EXPECT_EQ(policy.route(trucks[3], context()), 1u);
+
+    // A queued truck costs a full unload
+    queues[1].push_back(&trucks[4]);
+    EXPECT_EQ(policy.route(trucks[3], context()), 0u);
+}
+
+// Test that round-robin cycles through the stations
+TEST_F(DispatchTest, RoundRobin) {
+    RoundRobinDispatch policy;
+    for (size_t i = 0; i < 7; i++) {
+        EXPECT_EQ(policy.route(trucks[i % 6], context()), i % 3);
+    }
+}
+
+// Test that every rule accounts all truck time and agrees on a single station
+TEST(DispatchSimTest, SingleStationRulesAgree) {
+    std::vector<SimResults> results;
+    for (DispatchRule rule : {DispatchRule::FIFO, DispatchRule::SHORTEST_QUEUE,
+                              DispatchRule::LEAST_WAIT, DispatchRule::ROUND_ROBIN}) {
+        SimConfig config;
+        config.numTrucks = 6;
+        config.numStations = 1;
+        config.numThreads = 1;
+        config.seed = 4;
+        config.quiet = true;
+        config.horizonSecs = 12.0 * 3600.0;
+        config.dispatch = rule;
+        results.push_back(TruckSim(config).run());
+    }
+
+    for (const SimResults &result : results) {
+        EXPECT_DOUBLE_EQ(result.totalOperationalTime(), 6 * 12.0 * 3600.0);
+        EXPECT_EQ(result.tripsCompleted, results[0].tripsCompleted);
+        EXPECT_DOUBLE_EQ(result.totalIdleTime, results[0].totalIdleTime);
+    }
+    EXPECT_GT(results[0].totalIdleTime, 0.0);
+}
+
+// Test parsing the command-line names
+TEST(DispatchSimTest, ParseRule) {
+    EXPECT_EQ(parseDispatchRule("least-wait"), DispatchRule::LEAST_WAIT);
+    EXPECT_EQ(parseDispatchRule("round-robin"), DispatchRule::ROUND_ROBIN);
+    EXPECT_FALSE(parseDispatchRule("random").has_value());
+}
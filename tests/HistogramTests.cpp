@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../src/Histogram.hpp"
+#include "../src/Truck.hpp"
+
+// Test that small values are recorded exactly
+TEST(HistogramTest, ExactSmallValues) {
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 100; value++) {
+        histogram.record(value);
+    }
+
+    EXPECT_EQ(histogram.getCount(), 100);
+    EXPECT_EQ(histogram.getPercentile(50.0), 50);
+    EXPECT_EQ(histogram.getPercentile(99.0), 99);
+    EXPECT_EQ(histogram.getMax(), 100);
+    EXPECT_EQ(histogram.getMin(), 1);
+}
+
+// Test the relative error bound on large values
+TEST(HistogramTest, RelativeErrorOfLargeValues) {
+    Histogram histogram;
+    for (uint64_t value = 1000; value <= 100000; value += 1000) {
+        histogram.record(value);
+    }
+
+    for (double percentile : {50.0, 90.0, 99.0}) {
+        double expected = std::ceil(percentile) * 1000.0;
+        double actual = static_cast<double>(histogram.getPercentile(percentile));
+        EXPECT_NEAR(actual, expected, expected * 0.01);
+        EXPECT_GE(actual, expected);
+    }
+    EXPECT_EQ(histogram.getPercentile(100.0), 100000);
+}
+
+// Test that merged histograms match a single histogram of all values
+TEST(HistogramTest, Merge) {
+    Histogram even, odd, all;
+    for (uint64_t value = 0; value < 5000; value++) {
+        (value % 2 == 0 ? even : odd).record(value * 7);
+        all.record(value * 7);
+    }
+    even.merge(odd);
+
+    EXPECT_EQ(even.getCount(), all.getCount());
+    EXPECT_EQ(even.getMax(), all.getMax());
+    for (double percentile : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+        EXPECT_EQ(even.getPercentile(percentile), all.getPercentile(percentile));
+    }
+}
+
+// Test that a truck records its queue wait and cycle time
+TEST(HistogramTest, TruckRecordsTrip) {
+    TripHistograms histograms;
+    Truck truck(0, 1, 11);
+    float miningTime = truck.getMiningTimeLeft();
+
+    // Mine and travel to the station
+    while (truck.getState() != TruckState::UNLOADING) {
+        truck.update(&histograms);
+    }
+    // Wait 120s for a station, then unload and return to the site
+    truck.setState(TruckState::IDLE);
+    for (int i = 0; i < 120; i++) {
+        truck.update(&histograms);
+    }
+    truck.setState(TruckState::UNLOADING);
+    while (truck.getState() != TruckState::MINING) {
+        truck.update(&histograms);
+    }
+
+    EXPECT_EQ(histograms.queueWait.getCount(), 1);
+    EXPECT_EQ(histograms.queueWait.getMax(), 120);
+    EXPECT_EQ(histograms.cycleTime.getCount(), 1);
+    EXPECT_EQ(histograms.cycleTime.getMax(),
+              static_cast<uint64_t>(miningTime + 120 + Truck::UNLOAD_TIME +
+                                    2 * Truck::TRAVEL_TIME));
+}
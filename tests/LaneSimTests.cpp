@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "../src/LaneSim.hpp"
+#include <array>
+#include <vector>
+
+namespace {
+
+SimConfig laneConfig(uint32_t trucks, uint32_t stations) {
+    SimConfig config;
+    config.numTrucks = trucks;
+    config.numStations = stations;
+    config.numThreads = 1;
+    config.quiet = true;
+    config.horizonSecs = 72 * 3600.0;
+    return config;
+}
+
+// Checks every lane against a scalar run with the lane's seed
+template <size_t LANES>
+void expectLanesMatchScalar(const SimConfig &config, uint64_t baseSeed) {
+    std::array<uint64_t, LANES> seeds;
+    for (size_t l = 0; l < LANES; l++) {
+        seeds[l] = baseSeed + l;
+    }
+    std::vector<SimResults> lanes = LaneSim<LANES>(config, seeds).run();
+    ASSERT_EQ(lanes.size(), LANES);
+
+    for (size_t l = 0; l < LANES; l++) {
+        SimConfig scalarConfig = config;
+        scalarConfig.seed = seeds[l];
+        SimResults scalar = TruckSim(scalarConfig).run();
+        const SimResults &lane = lanes[l];
+        EXPECT_EQ(lane.durationSecs, scalar.durationSecs) << "lane " << l;
+        EXPECT_EQ(lane.warmupSecs, scalar.warmupSecs) << "lane " << l;
+        EXPECT_EQ(lane.totalMiningTime, scalar.totalMiningTime) << "lane " << l;
+        EXPECT_EQ(lane.totalUnloadTime, scalar.totalUnloadTime) << "lane " << l;
+        EXPECT_EQ(lane.totalTravelTime, scalar.totalTravelTime) << "lane " << l;
+        EXPECT_EQ(lane.totalIdleTime, scalar.totalIdleTime) << "lane " << l;
+        EXPECT_EQ(lane.totalStationOccupiedTime, scalar.totalStationOccupiedTime)
+            << "lane " << l;
+        EXPECT_EQ(lane.tripsCompleted, scalar.tripsCompleted) << "lane " << l;
+    }
+}
+
+} // namespace
+
+// Test that every lane reproduces the scalar engine with its seed
+TEST(LaneSimTest, MatchesScalarRuns) {
+    expectLanesMatchScalar<8>(laneConfig(5, 2), 11);
+    // Heavy queueing: many trucks per station
+    expectLanesMatchScalar<8>(laneConfig(20, 1), 300);
+}
+
+// Test the antithetic twin and a fixed warm-up ending mid-visit
+TEST(LaneSimTest, MatchesScalarAntitheticAndWarmup) {
+    SimConfig config = laneConfig(7, 2);
+    config.antithetic = true;
+    expectLanesMatchScalar<8>(config, 5);
+
+    config.antithetic = false;
+    config.warmupSecs = 10 * 3600.0 + 123;
+    expectLanesMatchScalar<8>(config, 42);
+
+    // Warm-up past the horizon is never reached
+    config.warmupSecs = 100 * 3600.0;
+    expectLanesMatchScalar<8>(config, 42);
+}
+
+// Test that replications fall back to scalar runs when lanes do not apply
+TEST(LaneSimTest, ReplicationsMatchAcrossEngines) {
+    SimConfig config = laneConfig(5, 2);
+    std::vector<uint64_t> seeds = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+
+    std::vector<SimResults> scalar = runReplications(config, seeds, 0);
+    std::vector<SimResults> lanes = runReplications(config, seeds, 8);
+    ASSERT_EQ(scalar.size(), seeds.size());
+    ASSERT_EQ(lanes.size(), seeds.size());
+    for (size_t i = 0; i < seeds.size(); i++) {
+        EXPECT_EQ(lanes[i].totalIdleTime, scalar[i].totalIdleTime);
+        EXPECT_EQ(lanes[i].tripsCompleted, scalar[i].tripsCompleted);
+    }
+
+    config.dispatch = DispatchRule::SHORTEST_QUEUE;
+    EXPECT_FALSE(LaneSim<8>::supports(config));
+    EXPECT_EQ(runReplications(config, seeds, 8).size(), seeds.size());
+}
+
+// Test that spreading the replications over a pool keeps their results and
+// seed order, for lane batches and scalar runs alike, even when the caller
+// asks for more threads per run
+TEST(LaneSimTest, ReplicationsOnPool) {
+    SimConfig config = laneConfig(5, 2);
+    config.numThreads = 4;
+    std::vector<uint64_t> seeds = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+    ThreadPool pool(3);
+
+    for (DispatchRule dispatch : {DispatchRule::FIFO, DispatchRule::SHORTEST_QUEUE}) {
+        config.dispatch = dispatch;
+        std::vector<SimResults> serial = runReplications(config, seeds, 8);
+        std::vector<SimResults> pooled = runReplications(config, seeds, 8, nullptr, &pool);
+        ASSERT_EQ(pooled.size(), seeds.size());
+        for (size_t i = 0; i < seeds.size(); i++) {
+            EXPECT_EQ(pooled[i].totalIdleTime, serial[i].totalIdleTime);
+            EXPECT_EQ(pooled[i].tripsCompleted, serial[i].tripsCompleted);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "../src/Optimizer.hpp"
+
+// Synthetic model: each station unloads 20 trucks' worth of trips, trucks
+// beyond that capacity wait
+static SimResults syntheticResults(const SimConfig &config) {
+    SimResults results;
+    results.numTrucks = config.numTrucks;
+    results.numStations = config.numStations;
+    results.durationSecs = 1000.0;
+
+    double capacity = 20.0 * config.numStations;
+    double busy = std::min<double>(config.numTrucks, capacity);
+    results.totalMiningTime = 1000.0 * busy;
+    results.totalIdleTime = 1000.0 * (config.numTrucks - busy);
+    results.totalStationOccupiedTime = 1000.0 * config.numStations * busy / capacity;
+    results.tripsCompleted = static_cast<uint64_t>(busy * 10);
+    return results;
+}
+
+class OptimizerTest : public ::testing::Test {
+protected:
+    OptimizerOptions options;
+    OptimizerConstraints constraints;
+    SimConfig base;
+
+    void SetUp() override {
+        options.replications = 2;
+        options.parallelism = 2;
+    }
+};
+
+// Test the minimum station count meeting an idle-rate target
+TEST_F(OptimizerTest, MinimumStations) {
+    base.numTrucks = 1000;
+    options.target = OptimizeTarget::STATIONS;
+    constraints.maxIdleRate = 5.0;
+
+    Optimizer search(base, constraints, options, syntheticResults);
+    std::optional<uint32_t> solution = search.solve();
+
+    // 48 stations serve 960 trucks (4% idle), 47 serve 940 (6% idle)
+    ASSERT_TRUE(solution.has_value());
+    EXPECT_EQ(*solution, 48u);
+    // Far fewer points than an exhaustive sweep of 1000 station counts
+    EXPECT_LT(search.getEvaluations().size(), 20u);
+    EXPECT_EQ(search.getSimulationsRun(),
+              search.getEvaluations().size() * options.replications);
+}
+
+// Test the minimum fleet keeping stations busy
+TEST_F(OptimizerTest, MinimumTrucks) {
+    base.numStations = 4;
+    options.target = OptimizeTarget::TRUCKS;
+    constraints.minStationUtilization = 75.0;
+    constraints.maxIdleRate = 10.0;
+
+    Optimizer search(base, constraints, options, syntheticResults);
+    std::optional<uint32_t> solution = search.solve();
+
+    // 60 of the 80 truck capacity is 75% utilization
+    ASSERT_TRUE(solution.has_value());
+    EXPECT_EQ(*solution, 60u);
+}
+
+// Test that conflicting constraints report no solution
+TEST_F(OptimizerTest, Infeasible) {
+    base.numTrucks = 100;
+    options.target = OptimizeTarget::STATIONS;
+    constraints.maxIdleRate = 0.0;
+    constraints.minStationUtilization = 99.0;
+    options.upperBound = 4;
+
+    Optimizer search(base, constraints, options, syntheticResults);
+    EXPECT_FALSE(search.solve().has_value());
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "../src/Reduction.hpp"
+#include <vector>
+
+// Test that compensation keeps small terms next to a large one
+TEST(ReductionTest, KahanSumCompensates) {
+    KahanSum sum;
+    double naive = 0.0;
+    sum.add(1e16);
+    naive += 1e16;
+    for (int i = 0; i < 10000; i++) {
+        sum.add(1.0);
+        naive += 1.0;
+    }
+    sum.add(-1e16);
+    naive += -1e16;
+
+    EXPECT_EQ(sum.get(), 10000.0);
+    EXPECT_NE(naive, 10000.0);
+}
+
+// Test that a reduction on the pool matches the inline reduction
+TEST(ReductionTest, ParallelMatchesInline) {
+    std::vector<double> values(100000);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = 0.1 * static_cast<double>(i % 97);
+    }
+    auto map = [&values](size_t begin, size_t end) {
+        KahanSum sum;
+        for (size_t i = begin; i < end; i++) {
+            sum.add(values[i]);
+        }
+        return sum;
+    };
+    auto combine = [](KahanSum &total, const KahanSum &partial) { total += partial; };
+
+    ThreadPool pool(4);
+    double inlineSum = parallelReduce<KahanSum>(nullptr, values.size(), 1000, map, combine).get();
+    double parallelSum = parallelReduce<KahanSum>(&pool, values.size(), 1000, map, combine).get();
+    EXPECT_NEAR(inlineSum, parallelSum, 1e-9);
+
+    KahanSum exact;
+    for (double value : values) {
+        exact.add(value);
+    }
+    EXPECT_EQ(inlineSum, exact.get());
+}
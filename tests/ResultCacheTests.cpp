@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "../src/LaneSim.hpp"
+#include "../src/ResultCache.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string cachePath(const std::string &name) {
+    std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+SimConfig seeded(uint64_t seed) {
+    SimConfig config;
+    config.numTrucks = 5;
+    config.numStations = 2;
+    config.numThreads = 1;
+    config.quiet = true;
+    config.horizonSecs = 24 * 3600.0;
+    config.seed = seed;
+    return config;
+}
+
+} // namespace
+
+// Test that keys cover the fields that change results and only those
+TEST(ResultCacheTest, Keys) {
+    SimConfig config = seeded(1);
+    std::optional<CacheKey> key = ResultCache::keyOf(config);
+    ASSERT_TRUE(key);
+
+    SimConfig other = config;
+    other.numThreads = 8;
+    other.quiet = false;
+    other.report.fullDump = true;
+    EXPECT_EQ(ResultCache::keyOf(other), key);
+
+    for (auto change : std::vector<void (*)(SimConfig &)>{
+             [](SimConfig &c) { c.seed = 2; },
+             [](SimConfig &c) { c.numTrucks++; },
+             [](SimConfig &c) { c.numStations++; },
+             [](SimConfig &c) { c.antithetic = true; },
+             [](SimConfig &c) { c.horizonSecs += 1.0; },
+             [](SimConfig &c) { c.warmupSecs = 3600.0; },
+             [](SimConfig &c) { c.autoWarmup = true; },
+             [](SimConfig &c) { c.dispatch = DispatchRule::LEAST_WAIT; }}) {
+        SimConfig changed = config;
+        change(changed);
+        EXPECT_NE(ResultCache::keyOf(changed), key);
+    }
+
+    other.seed = std::nullopt;
+    EXPECT_FALSE(ResultCache::keyOf(other));
+}
+
+// Test that results persist across instances and survive a torn append
+TEST(ResultCacheTest, PersistsAcrossInstances) {
+    std::string path = cachePath("results.cache");
+    SimResults results = TruckSim(seeded(3)).run();
+    {
+        ResultCache cache(path);
+        EXPECT_FALSE(cache.find(seeded(3)));
+        cache.insert(seeded(3), results);
+        EXPECT_TRUE(cache.find(seeded(3)));
+        EXPECT_EQ(cache.getHits(), 1u);
+        EXPECT_EQ(cache.getMisses(), 1u);
+    }
+    {
+        // A crash in the middle of an append leaves a partial record
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "partial";
+    }
+
+    ResultCache cache(path);
+    EXPECT_EQ(cache.size(), 1u);
+    std::optional<SimResults> found = cache.find(seeded(3), true);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->totalIdleTime, results.totalIdleTime);
+    EXPECT_EQ(found->tripsCompleted, results.tripsCompleted);
+    EXPECT_EQ(found->queueWait.p99, results.queueWait.p99);
+
+    // Appends after the repair are read back by another instance
+    cache.insert(seeded(4), TruckSim(seeded(4)).run());
+    EXPECT_TRUE(ResultCache(path).find(seeded(4)));
+    std::remove(path.c_str());
+}
+
+// Test that records appended by another instance are picked up on a miss,
+// and that compaction keeps one complete record per key
+TEST(ResultCacheTest, SharedAndCompacted) {
+    std::string path = cachePath("shared.cache");
+    ResultCache reader(path);
+    ResultCache writer(path);
+
+    std::vector<uint64_t> seeds = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    runReplications(seeded(0), seeds, 8, &writer);
+    EXPECT_EQ(writer.size(), seeds.size());
+    std::optional<SimResults> lane = reader.find(seeded(1));
+    ASSERT_TRUE(lane);
+    EXPECT_FALSE(lane->hasPercentiles);
+    EXPECT_FALSE(reader.find(seeded(1), true));
+
+    // A scalar run upgrades the record with its percentiles
+    writer.insert(seeded(1), TruckSim(seeded(1)).run());
+    EXPECT_TRUE(reader.find(seeded(1), true));
+
+    std::ifstream before(path, std::ios::binary | std::ios::ate);
+    std::streamoff sizeBefore = before.tellg();
+    reader.compact();
+    std::ifstream after(path, std::ios::binary | std::ios::ate);
+    EXPECT_LT(after.tellg(), sizeBefore);
+    EXPECT_TRUE(writer.find(seeded(1), true));
+    EXPECT_EQ(ResultCache(path).size(), seeds.size());
+    std::remove(path.c_str());
+}
+
+// Test that an instance appending after another one compacted the file
+// writes to the new file rather than to the replaced one
+TEST(ResultCacheTest, InsertAfterForeignCompaction) {
+    std::string path = cachePath("foreign.cache");
+    ResultCache writer(path);
+    ResultCache other(path);
+
+    writer.insert(seeded(1), TruckSim(seeded(1)).run());
+    other.compact();
+    writer.insert(seeded(2), TruckSim(seeded(2)).run());
+
+    ResultCache fresh(path);
+    EXPECT_EQ(fresh.size(), 2u);
+    EXPECT_TRUE(fresh.find(seeded(2), true));
+    EXPECT_TRUE(other.find(seeded(2), true));
+    std::remove(path.c_str());
+}
+
+// Test that replications answered from the cache match simulated ones
+TEST(ResultCacheTest, ReplicationsHitCache) {
+    std::string path = cachePath("replications.cache");
+    ResultCache cache(path);
+    std::vector<uint64_t> seeds = {10, 11, 12};
+    std::vector<SimResults> first = runReplications(seeded(0), seeds, 0, &cache);
+    seeds.push_back(13);
+    std::vector<SimResults> second = runReplications(seeded(0), seeds, 0, &cache);
+
+    EXPECT_EQ(cache.getHits(), 3u);
+    EXPECT_EQ(cache.getMisses(), 4u);
+    for (size_t i = 0; i < first.size(); i++) {
+        EXPECT_EQ(second[i].totalIdleTime, first[i].totalIdleTime);
+        EXPECT_EQ(second[i].serviceTime.p50, first[i].serviceTime.p50);
+    }
+    std::remove(path.c_str());
+}
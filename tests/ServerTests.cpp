@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "../src/SimServer.hpp"
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Minimal blocking client of the server protocol
+class TestClient {
+    int m_fd;
+
+public:
+    explicit TestClient(const std::string &path) {
+        m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        EXPECT_EQ(connect(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+    }
+    ~TestClient() { close(m_fd); }
+
+    // Reads everything until the server closes the connection, returning the
+    // number of bytes received
+    size_t drain() {
+        std::vector<char> buffer(1 << 16);
+        size_t total = 0;
+        ssize_t n;
+        while ((n = read(m_fd, buffer.data(), buffer.size())) > 0) {
+            total += static_cast<size_t>(n);
+        }
+        return total;
+    }
+
+    void send(ServerFrame type, const std::vector<char> &payload) {
+        uint32_t length = static_cast<uint32_t>(payload.size() + 1);
+        std::vector<char> frame(sizeof(length));
+        std::memcpy(frame.data(), &length, sizeof(length));
+        frame.push_back(static_cast<char>(type));
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        ASSERT_EQ(write(m_fd, frame.data(), frame.size()), static_cast<ssize_t>(frame.size()));
+    }
+
+    void run(uint64_t id, const std::vector<minesim_config> &configs) {
+        std::vector<char> payload(sizeof(id) + sizeof(uint32_t) + configs.size() * sizeof(minesim_config));
+        uint32_t count = static_cast<uint32_t>(configs.size());
+        std::memcpy(payload.data(), &id, sizeof(id));
+        std::memcpy(payload.data() + sizeof(id), &count, sizeof(count));
+        std::memcpy(payload.data() + sizeof(id) + sizeof(count), configs.data(),
+                    configs.size() * sizeof(minesim_config));
+        send(ServerFrame::RUN, payload);
+    }
+
+    void cancel(uint64_t id) {
+        std::vector<char> payload(sizeof(id));
+        std::memcpy(payload.data(), &id, sizeof(id));
+        send(ServerFrame::CANCEL, payload);
+    }
+
+    // Reads one frame, returning its type and payload
+    ServerFrame receive(std::vector<char> &payload) {
+        uint32_t length = 0;
+        EXPECT_EQ(read(m_fd, &length, sizeof(length)), static_cast<ssize_t>(sizeof(length)));
+        std::vector<char> frame(length);
+        size_t got = 0;
+        while (got < length) {
+            ssize_t n = read(m_fd, frame.data() + got, length - got);
+            if (n <= 0) {
+                ADD_FAILURE() << "connection closed";
+                return ServerFrame::DONE;
+            }
+            got += static_cast<size_t>(n);
+        }
+        payload.assign(frame.begin() + 1, frame.end());
+        return static_cast<ServerFrame>(frame[0]);
+    }
+
+    // Collects the results of a request up to its DONE frame
+    int32_t collect(uint64_t id, std::vector<minesim_result> &results) {
+        std::vector<char> payload;
+        while (true) {
+            ServerFrame type = receive(payload);
+            uint64_t frameId;
+            std::memcpy(&frameId, payload.data(), sizeof(frameId));
+            EXPECT_EQ(frameId, id);
+            if (type == ServerFrame::DONE) {
+                int32_t status;
+                std::memcpy(&status, payload.data() + sizeof(frameId), sizeof(status));
+                return status;
+            }
+            EXPECT_EQ(type, ServerFrame::RESULT);
+            uint32_t index;
+            std::memcpy(&index, payload.data() + sizeof(frameId), sizeof(index));
+            if (index >= results.size()) {
+                results.resize(index + 1);
+            }
+            std::memcpy(&results[index], payload.data() + sizeof(frameId) + sizeof(index),
+                        sizeof(minesim_result));
+        }
+    }
+};
+
+class ServerTest : public ::testing::Test {
+protected:
+    std::string m_path = ::testing::TempDir() + "minesim_test.sock";
+    std::unique_ptr<SimServer> m_server;
+    std::thread m_thread;
+
+    void start(uint32_t workers, uint32_t maxInFlight = 0, size_t maxBacklog = 0) {
+        ServerOptions options;
+        options.socketPath = m_path;
+        options.numWorkers = workers;
+        options.maxInFlight = maxInFlight;
+        options.maxBacklog = maxBacklog;
+        m_server = std::make_unique<SimServer>(options);
+        m_thread = std::thread([this]() { m_server->run(); });
+    }
+
+    void TearDown() override {
+        if (m_server) {
+            m_server->stop();
+            m_thread.join();
+            m_server.reset();
+        }
+    }
+
+    static minesim_config config(uint32_t trucks, uint32_t stations, uint64_t seed,
+                                 double hours = 8.0) {
+        minesim_config config;
+        minesim_config_init(&config);
+        config.num_trucks = trucks;
+        config.num_stations = stations;
+        config.seed = seed;
+        config.horizon_secs = hours * 3600.0;
+        return config;
+    }
+};
+
+} // namespace
+
+// Test that every configuration of a request is answered like a local run
+TEST_F(ServerTest, StreamsResults) {
+    start(2);
+    TestClient client(m_path);
+    std::vector<minesim_config> configs = {config(4, 1, 1), config(6, 2, 2), config(3, 1, 3)};
+    client.run(7, configs);
+
+    std::vector<minesim_result> results;
+    EXPECT_EQ(client.collect(7, results), MINESIM_OK);
+    ASSERT_EQ(results.size(), configs.size());
+    for (size_t i = 0; i < configs.size(); i++) {
+        SimResults expected = TruckSim(toSimConfig(configs[i])).run();
+        EXPECT_EQ(results[i].status, MINESIM_OK);
+        EXPECT_EQ(results[i].total_idle_time, expected.totalIdleTime);
+        EXPECT_EQ(results[i].trips_completed, expected.tripsCompleted);
+        EXPECT_EQ(results[i].queue_wait.p99, expected.queueWait.p99);
+    }
+
+    // The same connection keeps serving, including invalid configurations
+    configs[0].warmup_secs = configs[0].horizon_secs;
+    client.run(8, {configs[0]});
+    results.clear();
+    EXPECT_EQ(client.collect(8, results), MINESIM_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(m_server->getServed(), 4u);
+}
+
+// Test that a request above the admission limit is rejected as a whole
+TEST_F(ServerTest, AdmissionControl) {
+    start(1, 2);
+    TestClient client(m_path);
+    client.run(1, {config(2, 1, 1), config(2, 1, 2), config(2, 1, 3)});
+    std::vector<minesim_result> results;
+    EXPECT_EQ(client.collect(1, results), MINESIM_ERR_BUSY);
+    EXPECT_TRUE(results.empty());
+
+    client.run(2, {config(2, 1, 1), config(2, 1, 2)});
+    EXPECT_EQ(client.collect(2, results), MINESIM_OK);
+    EXPECT_EQ(results.size(), 2u);
+}
+
+// Test that cancelling stops the running configuration and skips the rest
+TEST_F(ServerTest, Cancel) {
+    start(1);
+    TestClient client(m_path);
+    // Far longer than the test could wait for
+    client.run(3, {config(4, 2, 1, 1e7), config(4, 2, 2, 1e7)});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    client.cancel(3);
+
+    std::vector<minesim_result> results;
+    EXPECT_EQ(client.collect(3, results), MINESIM_ERR_CANCELLED);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].status, MINESIM_ERR_CANCELLED);
+    EXPECT_EQ(results[1].status, MINESIM_ERR_CANCELLED);
+}
+
+// Test that a client that never reads its results is dropped instead of
+// stalling the workers serving the other clients
+TEST_F(ServerTest, SlowClientDropped) {
+    const uint32_t count = 20000;
+    start(1, count + 1, 4096);
+    TestClient slow(m_path);
+    std::vector<minesim_config> configs(count, config(1, 1, 1, 0.5));
+    slow.run(1, configs);
+
+    TestClient client(m_path);
+    client.run(2, {config(2, 1, 2)});
+    std::vector<minesim_result> results;
+    EXPECT_EQ(client.collect(2, results), MINESIM_OK);
+    EXPECT_EQ(results.size(), 1u);
+
+    // Once every configuration is answered, the slow client has only what its
+    // socket buffered before the drop
+    for (int i = 0; i < 1000 && m_server->getServed() < count + 1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(m_server->getServed(), count + 1);
+    EXPECT_LT(slow.drain(), count * (sizeof(minesim_result) + 17));
+}
+
+// Test that only a stale socket is replaced: a live server's socket and any
+// other file at the path are left alone
+TEST_F(ServerTest, ReplacesOnlyStaleSocket) {
+    ServerOptions options;
+    options.socketPath = m_path;
+    options.numWorkers = 1;
+
+    // A socket bound by a process that is gone
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, m_path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(bind(stale, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+    close(stale);
+    start(1);
+
+    EXPECT_THROW(SimServer{options}, std::runtime_error);
+    TestClient client(m_path);
+    client.run(1, {config(2, 1, 1)});
+    std::vector<minesim_result> results;
+    EXPECT_EQ(client.collect(1, results), MINESIM_OK);
+
+    std::string filePath = ::testing::TempDir() + "minesim_not_a_socket";
+    std::ofstream(filePath) << "data";
+    options.socketPath = filePath;
+    EXPECT_THROW(SimServer{options}, std::runtime_error);
+    std::ifstream file(filePath);
+    std::string contents;
+    file >> contents;
+    EXPECT_EQ(contents, "data");
+    std::remove(filePath.c_str());
+}
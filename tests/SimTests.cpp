@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../src/TruckSim.hpp"
+#include "../src/Comparison.hpp"
 #include <sstream>
 #include <iostream>
 
@@ -7,9 +8,18 @@ class SimTest : public ::testing::Test {
 protected:
     void SetUp() override {
         // Set up simulations with different configurations
-        sim11 = new TruckSim(1, 1);
-        sim32 = new TruckSim(3, 2);
-        sim54 = new TruckSim(5, 4);
+        sim11 = fullReportSim(1, 1);
+        sim32 = fullReportSim(3, 2);
+        sim54 = fullReportSim(5, 4);
+    }
+
+    // Simulation printing the per-truck and per-station statistics
+    static TruckSim *fullReportSim(uint32_t numTrucks, uint32_t numStations) {
+        SimConfig config;
+        config.numTrucks = numTrucks;
+        config.numStations = numStations;
+        config.report.fullDump = true;
+        return new TruckSim(config);
     }
 
     void TearDown() override {
@@ -81,4 +91,142 @@ TEST_F(SimTest, MoreStationsThanTrucks) {
         EXPECT_TRUE(output.find("Station " + std::to_string(i) + " stats:") != std::string::npos);
     }
     
-}
\ No newline at end of file
+}
+
+// Test that the default report lists only the worst entities
+TEST(SimReportTest, SummaryReport) {
+    SimConfig config;
+    config.numTrucks = 20;
+    config.numStations = 3;
+    config.numThreads = 1;
+    config.seed = 4;
+    config.report.topK = 2;
+
+    std::stringstream buffer;
+    std::streambuf* oldCout = std::cout.rdbuf(buffer.rdbuf());
+    TruckSim(config).simulate();
+    std::cout.rdbuf(oldCout);
+    std::string output = buffer.str();
+
+    EXPECT_EQ(output.find("=== TRUCK STATISTICS ==="), std::string::npos);
+    EXPECT_NE(output.find("=== TOP 2 TRUCKS BY IDLE TIME ==="), std::string::npos);
+    EXPECT_NE(output.find("=== TOP 2 LEAST UTILIZED STATIONS ==="), std::string::npos);
+    EXPECT_NE(output.find("Truck Idle Rate: "), std::string::npos);
+
+    size_t truckLines = 0;
+    for (size_t pos = output.find("Truck ID "); pos != std::string::npos;
+         pos = output.find("Truck ID ", pos + 1)) {
+        truckLines++;
+    }
+    EXPECT_EQ(truckLines, 2u);
+}
+
+// Test the paired difference statistics used by comparisons
+TEST(ComparisonTest, PairedDifferenceInterval) {
+    PairedDifference stats;
+    stats.add(10.0, 12.0);
+    stats.add(11.0, 12.5);
+    stats.add(9.0, 11.5);
+
+    EXPECT_EQ(stats.getCount(), 3);
+    EXPECT_DOUBLE_EQ(stats.getMeanA(), 10.0);
+    EXPECT_DOUBLE_EQ(stats.getMeanDiff(), 2.0);
+    EXPECT_DOUBLE_EQ(stats.getStdDev(), 0.5);
+    // t(0.975, 2) * 0.5 / sqrt(3)
+    EXPECT_NEAR(stats.getHalfWidth(), 4.303 * 0.5 / std::sqrt(3.0), 1e-9);
+}
+
+// Test that spreading the replication pairs over a pool leaves the result unchanged
+TEST(ComparisonTest, PooledMatchesSingleThread) {
+    SimConfig configA;
+    configA.numTrucks = 12;
+    configA.numStations = 2;
+    configA.horizonSecs = 12.0 * 3600.0;
+    SimConfig configB = configA;
+    configB.numStations = 3;
+
+    ComparisonOptions options;
+    options.replications = 5;
+    options.antithetic = true;
+    options.parallelism = 1;
+    Comparison single(configA, configB, options);
+    single.run();
+    options.parallelism = 3;
+    Comparison pooled(configA, configB, options);
+    pooled.run();
+
+    for (int m = 0; m < Comparison::COUNT; m++) {
+        auto metric = static_cast<Comparison::Metric>(m);
+        EXPECT_EQ(pooled.getStats(metric).getCount(), 5u);
+        EXPECT_DOUBLE_EQ(pooled.getStats(metric).getMeanDiff(),
+                         single.getStats(metric).getMeanDiff());
+        EXPECT_DOUBLE_EQ(pooled.getStats(metric).getStdDev(),
+                         single.getStats(metric).getStdDev());
+    }
+}
+
+// Test that the horizon is configurable and every truck accounts each tick once
+TEST(SimHorizonTest, ShortHorizon) {
+    SimConfig config;
+    config.numTrucks = 3;
+    config.numStations = 1;
+    config.numThreads = 1;
+    config.seed = 9;
+    config.quiet = true;
+    config.horizonSecs = 10.0 * 3600.0;
+
+    SimResults results = TruckSim(config).run();
+
+    EXPECT_DOUBLE_EQ(results.durationSecs, config.horizonSecs);
+    EXPECT_DOUBLE_EQ(results.warmupSecs, 0.0);
+    EXPECT_DOUBLE_EQ(results.totalOperationalTime(), 3 * config.horizonSecs);
+    EXPECT_GT(results.tripsCompleted, 0u);
+}
+
+// Test that a fixed warm-up is excluded from the statistics
+TEST(SimHorizonTest, FixedWarmup) {
+    SimConfig config;
+    config.numTrucks = 3;
+    config.numStations = 1;
+    config.numThreads = 1;
+    config.seed = 9;
+    config.quiet = true;
+    config.horizonSecs = 10.0 * 3600.0;
+    config.warmupSecs = 4.0 * 3600.0;
+
+    SimResults results = TruckSim(config).run();
+
+    EXPECT_DOUBLE_EQ(results.warmupSecs, config.warmupSecs);
+    EXPECT_DOUBLE_EQ(results.durationSecs, 6.0 * 3600.0);
+    EXPECT_DOUBLE_EQ(results.totalOperationalTime(), 3 * 6.0 * 3600.0);
+    EXPECT_LE(results.totalStationOccupiedTime, results.durationSecs);
+}
+
+// Test MSER-5 on a series with an initial transient
+TEST(WarmupDetectorTest, DetectsTransient) {
+    WarmupDetector detector;
+    EXPECT_FALSE(detector.truncationPoint().has_value());
+
+    // 50 observations decaying from 1 to 0, then 150 noisy steady ones
+    for (int i = 0; i < 50; i++) {
+        detector.add(1.0 - i / 50.0);
+    }
+    for (int i = 0; i < 150; i++) {
+        detector.add(i % 2 == 0 ? 0.05 : -0.05);
+    }
+
+    std::optional<uint64_t> truncation = detector.truncationPoint();
+    ASSERT_TRUE(truncation.has_value());
+    EXPECT_GE(*truncation, 30u);
+    EXPECT_LE(*truncation, 55u);
+}
+
+// Test that the batch series stays bounded on long runs
+TEST(WarmupDetectorTest, BoundedMemory) {
+    WarmupDetector detector;
+    for (int i = 0; i < 100000; i++) {
+        detector.add(i % 3);
+    }
+    EXPECT_EQ(detector.getObservations(), 100000u);
+    EXPECT_LE(detector.getBatchCount(), WarmupDetector::MAX_BATCHES);
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "../src/ThreadPool.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Test that the telemetry accounts every task and its start latency
+TEST(ThreadPoolTest, TelemetryCountsTasks) {
+    ThreadPool pool(2, true);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; i++) {
+        futures.push_back(pool.enqueue([] {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }));
+    }
+    for (auto &future : futures) {
+        future.wait();
+    }
+
+    // A worker counts its task just after fulfilling the future
+    PoolTelemetry telemetry = pool.telemetry();
+    for (int attempt = 0; attempt < 1000 && telemetry.total().tasksRun < 100; attempt++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        telemetry = pool.telemetry();
+    }
+
+    ASSERT_EQ(telemetry.workers.size(), 2u);
+    WorkerTelemetry total = telemetry.total();
+    EXPECT_EQ(telemetry.tasksEnqueued, 100u);
+    EXPECT_EQ(total.tasksRun, 100u);
+    EXPECT_EQ(total.startLatencyNs.getCount(), 100u);
+    EXPECT_GE(total.busyNs, 100u * 50000u);
+    EXPECT_GE(telemetry.maxQueueDepth, 1u);
+    EXPECT_GT(telemetry.utilization(), 0.0);
+}
+
+// Test that a pool without telemetry reports nothing
+TEST(ThreadPoolTest, TelemetryOff) {
+    ThreadPool pool(2);
+    pool.enqueue([] {}).wait();
+    EXPECT_FALSE(pool.hasTelemetry());
+    EXPECT_TRUE(pool.telemetry().workers.empty());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "../src/TimingWheel.hpp"
+#include "../src/Truck.hpp"
+#include <random>
+#include <vector>
+
+// Test that every entry expires exactly on its deadline, across all levels
+TEST(TimingWheelTest, ExpiresOnDeadline) {
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> deadlines;
+    // Near, cascading and beyond-range delays
+    for (uint64_t delay : {1ULL, 63ULL, 64ULL, 4095ULL, 4096ULL, 262144ULL,
+                           (1ULL << 24) + 5}) {
+        deadlines.push_back(delay);
+    }
+    while (deadlines.size() < 500) {
+        deadlines.push_back(1 + rng() % 20000);
+    }
+
+    TimingWheel wheel(deadlines.size());
+    for (uint32_t id = 0; id < deadlines.size(); id++) {
+        wheel.schedule(id, deadlines[id]);
+    }
+    EXPECT_EQ(wheel.size(), deadlines.size());
+
+    std::vector<uint64_t> expired(deadlines.size(), 0);
+    while (wheel.size() > 0) {
+        wheel.advance([&](uint32_t id) { expired[id] = wheel.now(); });
+    }
+    EXPECT_EQ(expired, deadlines);
+}
+
+// Test that a deadline that is not after the clock expires on the next tick
+// instead of waiting for the wheel to come around
+TEST(TimingWheelTest, PastDeadlineExpiresNextTick) {
+    TimingWheel wheel(3, 100);
+    wheel.schedule(0, 100);
+    wheel.schedule(1, 5);
+    wheel.schedule(2, 101);
+
+    std::vector<uint32_t> expired;
+    wheel.advance([&](uint32_t id) { expired.push_back(id); });
+    EXPECT_EQ(wheel.now(), 101u);
+    EXPECT_EQ(expired.size(), 3u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+// Test that entries can be re-scheduled from the expiry callback
+TEST(TimingWheelTest, RescheduleOnExpiry) {
+    TimingWheel wheel(2);
+    wheel.schedule(0, 10);
+    wheel.schedule(1, 100);
+
+    std::vector<uint64_t> ticks;
+    while (wheel.now() < 1000) {
+        wheel.advance([&](uint32_t id) {
+            if (id == 0) {
+                ticks.push_back(wheel.now());
+                wheel.schedule(0, wheel.now() + 70);
+            }
+        });
+    }
+    ASSERT_EQ(ticks.size(), 15u);
+    for (size_t i = 0; i < ticks.size(); i++) {
+        EXPECT_EQ(ticks[i], 10 + 70 * i);
+    }
+}
+
+// Test that expiring a truck at its deadlines matches stepping it every tick
+TEST(TimingWheelTest, TruckExpiryMatchesUpdate) {
+    Truck stepped(4, 1, 21);
+    Truck expired(4, 1, 21);
+    TimingWheel wheel(1);
+    wheel.schedule(0, expired.getDeadline());
+
+    for (int tick = 0; tick < 100000; tick++) {
+        stepped.update();
+        wheel.advance([&](uint32_t) {
+            expired.expire(wheel.now());
+            wheel.schedule(0, expired.getDeadline());
+        });
+        EXPECT_EQ(stepped.getState(), expired.getState());
+    }
+    stepped.flushStats();
+    expired.flushStats(wheel.now());
+    EXPECT_EQ(stepped.getMiningTimeTotal(), expired.getMiningTimeTotal());
+    EXPECT_EQ(stepped.getTravelTimeTotal(), expired.getTravelTimeTotal());
+    EXPECT_EQ(stepped.getUnloadTimeTotal(), expired.getUnloadTimeTotal());
+    EXPECT_EQ(stepped.getTripsCompleted(), expired.getTripsCompleted());
+    EXPECT_EQ(stepped.getMiningTimeTotal() + stepped.getTravelTimeTotal() +
+                  stepped.getUnloadTimeTotal(),
+              100000.0);
+}
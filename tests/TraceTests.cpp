@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "../src/MiningTrace.hpp"
+#include "../src/TruckSim.hpp"
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MiningTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "mining_trace_test.bin";
+        MiningTrace::write(path, {{3600.0f, 7200.0f}, {5400.0f}, {4000.0f, 9000.0f, 18000.0f}});
+    }
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+    std::string path;
+};
+
+// Test that the mapped sequences match the written ones
+TEST_F(MiningTraceTest, RoundTrip) {
+    MiningTrace trace(path);
+    ASSERT_EQ(trace.getNumTrucks(), 3u);
+    EXPECT_EQ(trace.getDurations(0).size(), 2u);
+    EXPECT_EQ(trace.getDurations(1)[0], 5400.0f);
+    EXPECT_EQ(trace.getDurations(2)[2], 18000.0f);
+}
+
+// Test that a truck replays its sequence in order and wraps around
+TEST_F(MiningTraceTest, TruckReplaysDurations) {
+    MiningTrace trace(path);
+    Truck truck(0, 1, trace.getDurations(0));
+    EXPECT_EQ(truck.getMiningTimeLeft(), 3600.0f);
+    EXPECT_EQ(truck.nextMiningTime(), 7200.0f);
+    EXPECT_EQ(truck.nextMiningTime(), 3600.0f);
+    EXPECT_EQ(truck.nextMiningTime(), 7200.0f);
+}
+
+// Test that a replayed workload is identical whatever the seed, so station
+// layouts are compared on the same mining durations
+TEST_F(MiningTraceTest, DeterministicReplay) {
+    SimConfig config;
+    config.numTrucks = 6;
+    config.numStations = 1;
+    config.numThreads = 1;
+    config.quiet = true;
+    config.horizonSecs = 24 * 3600.0;
+    config.trace = std::make_shared<MiningTrace>(path);
+
+    config.seed = 1;
+    SimResults first = TruckSim(config).run();
+    config.seed = 2;
+    SimResults second = TruckSim(config).run();
+    EXPECT_EQ(first.totalMiningTime, second.totalMiningTime);
+    EXPECT_EQ(first.totalIdleTime, second.totalIdleTime);
+    EXPECT_EQ(first.tripsCompleted, second.tripsCompleted);
+
+    // A second station only shortens the queues
+    config.numStations = 2;
+    SimResults twoStations = TruckSim(config).run();
+    EXPECT_LE(twoStations.totalIdleTime, first.totalIdleTime);
+    EXPECT_GE(twoStations.tripsCompleted, first.tripsCompleted);
+}
+
+// Test that malformed files are rejected
+TEST_F(MiningTraceTest, RejectsInvalidFiles) {
+    EXPECT_THROW(MiningTrace{"/nonexistent/trace.bin"}, std::runtime_error);
+
+    std::string bad = ::testing::TempDir() + "mining_trace_bad.bin";
+    {
+        std::ofstream out(bad, std::ios::binary);
+        out << "NOTATRACE-------------------";
+    }
+    EXPECT_THROW(MiningTrace{bad}, std::runtime_error);
+
+    MiningTrace::write(bad, {{3600.0f}, {}});
+    EXPECT_THROW(MiningTrace{bad}, std::runtime_error);
+    std::remove(bad.c_str());
+}
+
+// Test that durations outside [MIN_DURATION, MAX_DURATION] are rejected:
+// shorter than a tick, beyond any tick count, or not a number
+TEST_F(MiningTraceTest, RejectsOutOfRangeDurations) {
+    std::string bad = ::testing::TempDir() + "mining_trace_range.bin";
+    for (float duration : {0.0f, -5.0f, 0.5f, 3.0e9f, std::nanf(""), INFINITY}) {
+        MiningTrace::write(bad, {{3600.0f, duration}});
+        EXPECT_THROW(MiningTrace{bad}, std::runtime_error) << duration;
+    }
+    MiningTrace::write(bad, {{MiningTrace::MIN_DURATION, MiningTrace::MAX_DURATION}});
+    EXPECT_NO_THROW(MiningTrace{bad});
+    std::remove(bad.c_str());
+}
+
+// Test that a forged duration count whose size in bytes wraps around is
+// rejected instead of passing the size check
+TEST_F(MiningTraceTest, RejectsOverflowingOffsets) {
+    std::string bad = ::testing::TempDir() + "mining_trace_overflow.bin";
+    MiningTrace::write(bad, {{3600.0f}});
+    {
+        // 2^62 + 1 floats are 2^64 + 4 bytes, i.e. 4 after the
+        // multiplication: exactly the one duration the file holds
+        std::fstream file(bad, std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t offsets[2] = {0, (1ull << 62) + 1};
+        file.seekp(16);
+        file.write(reinterpret_cast<const char *>(offsets), sizeof(offsets));
+    }
+    EXPECT_THROW(MiningTrace{bad}, std::runtime_error);
+
+    {
+        std::ofstream truncated(bad, std::ios::binary | std::ios::trunc);
+        truncated.write("MSTRACE1", 8);
+        uint32_t fields[2] = {1, 1};
+        truncated.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+        uint64_t offsets[2] = {0, 1};
+        truncated.write(reinterpret_cast<const char *>(offsets), sizeof(offsets));
+    }
+    EXPECT_THROW(MiningTrace{bad}, std::runtime_error);
+    std::remove(bad.c_str());
+}
+
+// Test that the automatic warm-up follows a real initial transient: trucks
+// first replay short mining periods that congest the station, then long ones
+// under which the queue disappears, so a longer congested phase must move
+// the detected truncation point later
+TEST_F(MiningTraceTest, AutoWarmupFollowsTransient) {
+    SimConfig config;
+    config.numTrucks = 30;
+    config.numStations = 1;
+    config.numThreads = 1;
+    config.quiet = true;
+    config.horizonSecs = 240 * 3600.0;
+    config.autoWarmup = true;
+
+    auto detectedWarmup = [&](size_t congestedCycles) {
+        std::vector<float> durations(congestedCycles, 600.0f);
+        durations.resize(congestedCycles + 100, 18000.0f);
+        MiningTrace::write(path, {durations});
+        config.trace = std::make_shared<MiningTrace>(path);
+        SimResults results = TruckSim(config).run();
+        EXPECT_DOUBLE_EQ(results.durationSecs + results.warmupSecs, config.horizonSecs);
+        return results.warmupSecs;
+    };
+
+    double shortTransient = detectedWarmup(4);
+    double longTransient = detectedWarmup(8);
+    EXPECT_GT(shortTransient, 0.0);
+    // Congested, the 30 trucks complete a cycle every 30 unloads of 300s
+    EXPECT_NEAR(longTransient - shortTransient, 4 * 30 * 300.0, 2 * 3600.0);
+}
@@ -47,4 +47,29 @@ TEST_F(TruckTest, MiningToTravelingTransition) {
     EXPECT_EQ(truck->getMiningTimeTotal(), initialMiningTime);
 }
 
+// Test that trucks sharing a seed and id draw the same mining durations
+TEST(TruckStreamTest, CommonRandomNumbers) {
+    Truck a(3, 1, 42);
+    Truck b(3, 1, 42);
+    Truck other(3, 1, 43);
+
+    EXPECT_EQ(a.getMiningTimeLeft(), b.getMiningTimeLeft());
+    EXPECT_NE(a.getMiningTimeLeft(), other.getMiningTimeLeft());
+    for (int cycle = 0; cycle < 10; cycle++) {
+        EXPECT_EQ(a.getRandomMiningTime(), b.getRandomMiningTime());
+    }
+}
+
+// Test that an antithetic truck mirrors the durations of its twin
+TEST(TruckStreamTest, AntitheticDurations) {
+    Truck regular(5, 1, 7);
+    Truck mirrored(5, 1, 7, true);
+
+    for (int cycle = 0; cycle < 10; cycle++) {
+        float sum = regular.getRandomMiningTime() + mirrored.getRandomMiningTime();
+        // 1h + 5h, the mirrored draws average to the middle of the range
+        EXPECT_NEAR(sum, 6.0f * 3600.0f, 0.1f);
+    }
+}
+
 // Rest of state transition tests would go here...
\ No newline at end of file